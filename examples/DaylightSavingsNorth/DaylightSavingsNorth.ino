@@ -79,15 +79,15 @@ void loop()
   TM localTime;
   {
     /**
-     * Read the local time and print it. Then convert the local time to UTC
-     * (Greenwich meantime) and print it.
+     * Read the local time along with UTC (Greenwich meantime) and
+     * print both.
      */
-    RtcDueRcf::clock.getLocalTime(localTime);
+    std::time_t utc;
+    RtcDueRcf::clock.getTime(localTime, utc);
     Serial.print("Local time: ");
     Serial.print(localTime);
     Serial.print(localTime.tm_isdst ? " Dayl. savg." : " Normal Time");
 
-    const std::time_t utc = std::mktime(&localTime);
     TM utcTime;
     gmtime_r(&utc, &utcTime);
     Serial.print(", (UTC=");
@@ -0,0 +1,249 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+/*
+ * Host test for the RtcDueRcf_DriftEstimator with synthetic drift traces.
+ *
+ * Build and run from this directory:
+ *   g++ -std=c++11 -O2 ../../src/RtcDueRcf_DriftEstimator.cpp RtcDueRcf_DriftEstimator_test.cpp -o drift_test && ./drift_test
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "../../src/RtcDueRcf_DriftEstimator.h"
+
+namespace {
+
+constexpr std::time_t START = 1654077600; // 1st of June 2022 10:00:00h UTC
+constexpr std::time_t HOUR = 3600;
+
+/* Deterministic jitter of the reference in [-amplitude..amplitude] microseconds. */
+int32_t jitter(uint32_t& seed, const int32_t amplitude) {
+  seed = seed * 1664525 + 1013904223;
+  return static_cast<int32_t>(seed >> 8) % (amplitude + 1) * ((seed & 1) ? 1 : -1);
+}
+
+/* Simulated RTC, whose crystal runs with a drift. */
+struct SimulatedRtc {
+  double driftPpm;
+  double offsetMicros; // RTC minus reference
+
+  void run(const std::time_t seconds) {
+    offsetMicros += driftPpm * seconds;
+  }
+};
+
+void testInvalid() {
+  printf("--- %s\n", __FUNCTION__);
+  RtcDueRcf_DriftEstimator estimator;
+  assert(not estimator.isValid());
+  estimator.addSample(START, 0);
+  assert(not estimator.isValid());
+  estimator.addSample(START + RtcDueRcf_DriftEstimator::MIN_SPAN_SECONDS - 1, 0);
+  assert(not estimator.isValid());
+  estimator.addSample(START + RtcDueRcf_DriftEstimator::MIN_SPAN_SECONDS, 0);
+  assert(estimator.isValid());
+  estimator.reset();
+  assert(not estimator.isValid() && estimator.samples() == 0);
+}
+
+void testConstantDrift(const double driftPpm, const int32_t jitterMicros) {
+  printf("--- %s %+.1fppm jitter %dus\n", __FUNCTION__, driftPpm, jitterMicros);
+  RtcDueRcf_DriftEstimator estimator;
+  SimulatedRtc rtc = {driftPpm, 0};
+  uint32_t seed = 1;
+  for(int i = 0; i < 48; i++) {
+    estimator.addSample(START + i * HOUR, static_cast<int32_t>(lround(rtc.offsetMicros)) + jitter(seed, jitterMicros));
+    rtc.run(HOUR);
+  }
+  printf("  estimated %+.3fppm residual %.0fus\n", estimator.driftPpm(), estimator.residualMicros());
+  assert(estimator.samples() == RtcDueRcf_DriftEstimator::WINDOW_SIZE);
+  // 15 hours with the jitter at both ends.
+  assert(fabs(estimator.driftPpm() - driftPpm) < 2.0 * jitterMicros / (15 * HOUR) + 0.01);
+  assert(estimator.residualMicros() <= jitterMicros);
+  // The prediction for the next hour.
+  const std::time_t next = START + 48 * HOUR;
+  assert(labs(estimator.predictOffset(next) - lround(rtc.offsetMicros)) <= jitterMicros + 1);
+}
+
+/* Step the simulated RTC like RtcDueRcf::correctDrift() does. */
+void testCorrectedDrift() {
+  printf("--- %s\n", __FUNCTION__);
+  RtcDueRcf_DriftEstimator estimator;
+  SimulatedRtc rtc = {-35.0, 0}; // 3 seconds per day slow.
+  uint32_t seed = 7;
+  uint32_t ticket = 0;
+  int steps = 0;
+  for(int i = 0; i < 24 * 14; i++) {
+    estimator.commit(ticket);
+    estimator.addSample(START + i * HOUR, static_cast<int32_t>(lround(rtc.offsetMicros)) + jitter(seed, 5000));
+    if(estimator.isValid()) {
+      const int32_t offset = estimator.predictOffset(START + i * HOUR);
+      const int32_t seconds = (offset + (offset < 0 ? -500000 : 500000)) / 1000000;
+      if(seconds != 0) {
+        // Requested, then committed by the RTC.
+        estimator.requestStep(++ticket, -seconds * 1000000);
+        rtc.offsetMicros -= seconds * 1000000;
+        steps++;
+      }
+    }
+    // The steps must not disturb the estimation.
+    if(i >= 16) {
+      assert(fabs(estimator.driftPpm() - rtc.driftPpm) < 0.5);
+    }
+    // The RTC never deviates more than half a second plus one hour of drift.
+    assert(fabs(rtc.offsetMicros) < 500000 + 35.0 * HOUR + 5000);
+    rtc.run(HOUR);
+  }
+  printf("  %d steps within 2 weeks, estimated %+.3fppm\n", steps, estimator.driftPpm());
+  assert(steps >= 40 && steps <= 43);
+}
+
+/* The window forgets an old drift, e.g. when the temperature changes. */
+void testChangingDrift() {
+  printf("--- %s\n", __FUNCTION__);
+  RtcDueRcf_DriftEstimator estimator;
+  SimulatedRtc rtc = {20.0, 0};
+  int i = 0;
+  for(; i < 24; i++) {
+    estimator.addSample(START + i * HOUR, static_cast<int32_t>(lround(rtc.offsetMicros)));
+    rtc.run(HOUR);
+  }
+  assert(fabs(estimator.driftPpm() - 20.0) < 0.01);
+  rtc.driftPpm = -10.0;
+  for(; i < 24 + static_cast<int>(RtcDueRcf_DriftEstimator::WINDOW_SIZE); i++) {
+    estimator.addSample(START + i * HOUR, static_cast<int32_t>(lround(rtc.offsetMicros)));
+    rtc.run(HOUR);
+  }
+  printf("  estimated %+.3fppm\n", estimator.driftPpm());
+  // The first sample of the window is the last one of the old drift.
+  assert(fabs(estimator.driftPpm() + 10.0) < 0.01);
+}
+
+/*
+ * The RTC is resynced to the reference by a set time request of the
+ * user, while steps are being corrected. The samples before the resync
+ * must not disturb the estimation afterwards.
+ */
+void testResync() {
+  printf("--- %s\n", __FUNCTION__);
+  RtcDueRcf_DriftEstimator estimator;
+  SimulatedRtc rtc = {-35.0, 0};
+  uint32_t seed = 3;
+  uint32_t ticket = 0;
+  int i = 0;
+  for(; i < 24; i++) {
+    estimator.commit(ticket);
+    estimator.addSample(START + i * HOUR, static_cast<int32_t>(lround(rtc.offsetMicros)) + jitter(seed, 2000));
+    const int32_t offset = estimator.predictOffset(START + i * HOUR);
+    const int32_t seconds = (offset + (offset < 0 ? -500000 : 500000)) / 1000000;
+    if(estimator.isValid() && seconds != 0) {
+      estimator.requestStep(++ticket, -seconds * 1000000);
+      rtc.offsetMicros -= seconds * 1000000;
+    }
+    rtc.run(HOUR);
+  }
+  assert(fabs(estimator.driftPpm() + 35.0) < 0.5);
+
+  // Resync: The RTC has been 7 seconds off, e.g. after a power fail.
+  rtc.offsetMicros = 7000000;
+  estimator.commit(ticket);
+  estimator.addSample(START + i * HOUR, static_cast<int32_t>(lround(rtc.offsetMicros)));
+  rtc.offsetMicros = 1500;
+  estimator.commit(++ticket);
+  assert(estimator.samples() == 0 && not estimator.isValid());
+  assert(estimator.predictOffset(START + i * HOUR) == 0);
+  rtc.run(HOUR);
+  i++;
+
+  // Valid with the first 2 samples after the resync.
+  for(int n = 0; n < 4; n++, i++) {
+    estimator.commit(ticket);
+    estimator.addSample(START + i * HOUR, static_cast<int32_t>(lround(rtc.offsetMicros)) + jitter(seed, 2000));
+    if(n > 0) {
+      assert(estimator.isValid());
+      printf("  %d hours after resync: estimated %+.3fppm residual %.0fus\n", n, estimator.driftPpm(),
+          estimator.residualMicros());
+      assert(fabs(estimator.driftPpm() + 35.0) < 4.0 * 2000 / (n * HOUR) + 0.01);
+      assert(estimator.residualMicros() <= 2000);
+      assert(labs(estimator.predictOffset(START + i * HOUR) - lround(rtc.offsetMicros)) <= 4000);
+    }
+    rtc.run(HOUR);
+  }
+}
+
+/*
+ * A step is taken into account, when exactly its generation has been
+ * committed. A step that has been superseded by a set time request of
+ * the user never lands.
+ */
+void testStepCommit() {
+  printf("--- %s\n", __FUNCTION__);
+  RtcDueRcf_DriftEstimator estimator;
+  estimator.addSample(START, 0);
+  estimator.addSample(START + HOUR, 720000); // 200ppm
+  assert(estimator.isValid());
+
+  // Requested, but not yet committed: No effect.
+  estimator.requestStep(1, -1000000);
+  estimator.commit(0);
+  assert(estimator.predictOffset(START + HOUR) == 720000);
+  // A sample before the commit still carries the unstepped offset.
+  estimator.addSample(START + 2 * HOUR, 1440000);
+  estimator.commit(1);
+  assert(estimator.samples() == 3);
+  assert(estimator.predictOffset(START + 2 * HOUR) == 440000);
+  estimator.addSample(START + 3 * HOUR, 1160000);
+  assert(fabs(estimator.driftPpm() - 200.0) < 0.001 && estimator.residualMicros() < 1);
+
+  // Superseded by the user: The samples are forgotten.
+  estimator.requestStep(2, -1000000);
+  estimator.commit(3);
+  assert(estimator.samples() == 0 && not estimator.isValid());
+  assert(estimator.predictOffset(START + 3 * HOUR) == 0);
+
+  // A step that lands together with a later user request is lost too.
+  estimator.addSample(START + 4 * HOUR, 0);
+  estimator.requestStep(4, -1000000);
+  estimator.commit(5);
+  assert(estimator.samples() == 0);
+}
+
+} // anonymous namespace
+
+int main() {
+  testInvalid();
+  testConstantDrift(0.0, 0);
+  testConstantDrift(20.0, 0);
+  testConstantDrift(-35.0, 2000);
+  testConstantDrift(50.0, 20000);
+  testCorrectedDrift();
+  testChangingDrift();
+  testResync();
+  testStepCommit();
+  printf("All tests passed.\n");
+  return 0;
+}
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+#
+#  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+#  2024 Wolfgang Schmieder.  All right reserved.
+#
+#  Contributors:
+#  - Wolfgang Schmieder
+#
+#  Project home: https://github.com/dac1e/RtcDueRcf
+#
+#  This library is free software; you can redistribute it and/or modify it
+#  the terms of the GNU Lesser General Public License as under published
+#  by the Free Software Foundation; either version 3.0 of the License,
+#  or (at your option) any later version.
+#
+#  This library is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+#  Lesser General Public License for more details.
+#
+#  You should have received a copy of the GNU Lesser General Public
+#  License along with this library; if not, write to the Free Software
+#  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+
+"""
+Compile time zones of the tz database into RtcDueRcf_TzTable definitions.
+
+The transitions are taken from the tz database of the host, that Python's
+zoneinfo module reads. The format is described in src/RtcDueRcf_TzTable.h.
+
+Usage:
+  python3 RtcDueRcf_TzTableGen.py [--first 2000] [--last 2099] Europe/Berlin ... > TzTables.h
+"""
+
+import argparse
+import datetime
+import sys
+import zoneinfo
+
+TYPE_BITS = 3
+BLOCK_SIZE = 16
+
+# The scan step. Two transitions must be further apart.
+STEP = 6 * 3600
+
+
+def utc_timestamp(year):
+    return int(datetime.datetime(year, 1, 1, tzinfo=datetime.timezone.utc).timestamp())
+
+
+def zone_type(zone, utc):
+    """(seconds west of UTC, isdst) at the UTC time stamp utc."""
+    local = datetime.datetime.fromtimestamp(utc, zone)
+    return -int(local.utcoffset().total_seconds()), 1 if local.dst() else 0
+
+
+def transitions(zone, begin, end):
+    """The type before begin and the transitions [(utc, type)] within [begin, end)."""
+    initial = zone_type(zone, begin - 1)
+    result = []
+    current = initial
+    t = begin
+    while t < end:
+        following = zone_type(zone, min(t + STEP, end - 1))
+        if following != current:
+            # Bisect the first second of the following type.
+            lower, upper = t, min(t + STEP, end - 1)
+            while lower < upper:
+                mid = (lower + upper) // 2
+                if zone_type(zone, mid) == current:
+                    lower = mid + 1
+                else:
+                    upper = mid
+            current = zone_type(zone, lower)
+            result.append((lower, current))
+        t += STEP
+    return initial, result
+
+
+def encode(value):
+    """Little endian base 128."""
+    result = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            result.append(byte | 0x80)
+        else:
+            result.append(byte)
+            return result
+
+
+def compile_zone(name, first, last):
+    zone = zoneinfo.ZoneInfo(name)
+    initial, changes = transitions(zone, utc_timestamp(first), utc_timestamp(last + 1))
+
+    types = [initial]
+    for _, type_ in changes:
+        if type_ not in types:
+            types.append(type_)
+    if len(types) > 1 << TYPE_BITS:
+        raise ValueError('%s: more than %d types' % (name, 1 << TYPE_BITS))
+
+    blocks = []
+    data = bytearray()
+    previous = 0
+    for i, (utc, type_) in enumerate(changes):
+        if i % BLOCK_SIZE == 0:
+            blocks.append((utc, len(data)))
+            previous = utc
+        if (utc - previous) % 60:
+            raise ValueError('%s: transition at %d is not on a minute' % (name, utc))
+        data += encode(((utc - previous) // 60) << TYPE_BITS | types.index(type_))
+        previous = utc
+    if len(data) > 0xFFFF:
+        raise ValueError('%s: too many transitions' % name)
+    return types, blocks, data, len(changes), types.index(initial)
+
+
+def identifier(name):
+    return ''.join(c if c.isalnum() else '_' for c in name)
+
+
+def rows(items, per_row):
+    return ',\n'.join('    ' + ', '.join(items[i:i + per_row]) for i in range(0, len(items), per_row))
+
+
+def generate(names, first, last, out):
+    out.write('// Generated by RtcDueRcf_TzTableGen.py for the years %d..%d. Do not edit.\n\n' % (first, last))
+    out.write('#pragma once\n\n')
+    out.write('#include <RtcDueRcf_TzTable.h>\n\n')
+    out.write('static_assert(RtcDueRcf_TzTable::TYPE_BITS == %d && RtcDueRcf_TzTable::BLOCK_SIZE == %d,\n'
+              '    "Table format mismatch.");\n\n' % (TYPE_BITS, BLOCK_SIZE))
+    out.write('namespace TZ {\nnamespace TABLES {\n')
+    for name in names:
+        types, blocks, data, count, initial = compile_zone(name, first, last)
+        ident = identifier(name)
+        out.write('\n// %s: %d transitions, %d bytes\n' % (name, count, len(data)))
+        out.write('namespace %s_ {\n' % ident)
+        out.write('constexpr RtcDueRcf_TzTable::Type types[] = {\n%s\n};\n'
+                  % rows(['{%d, %d}' % t for t in types], 4))
+        out.write('constexpr RtcDueRcf_TzTable::Block blocks[] = {\n%s\n};\n'
+                  % rows(['{%d, %d}' % b for b in blocks] or ['{0, 0}'], 4))
+        out.write('constexpr uint8_t data[] = {\n%s\n};\n'
+                  % rows(['0x%02X' % b for b in data] or ['0'], 12))
+        out.write('} // namespace %s_\n' % ident)
+        out.write('constexpr RtcDueRcf_TzTable %s = {"%s", %s_::types, %s_::blocks, %d, %s_::data, %d, %d};\n'
+                  % (ident, name, ident, ident, len(blocks), ident, count, initial))
+    out.write('\n} // namespace TABLES\n} // namespace TZ\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile tz database zones into RtcDueRcf_TzTable definitions.')
+    parser.add_argument('--first', type=int, default=2000, help='first year (default 2000)')
+    parser.add_argument('--last', type=int, default=2099, help='last year (default 2099)')
+    parser.add_argument('zones', nargs='+', help='IANA time zone names, e.g. Europe/Berlin')
+    args = parser.parse_args()
+    generate(args.zones, args.first, args.last, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
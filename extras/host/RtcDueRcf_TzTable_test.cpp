@@ -0,0 +1,109 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+/*
+ * Host test for the RtcDueRcf_TzTable lookup against glibc's localtime_r()
+ * for the years 2000..2099. The tables are generated from the tz database
+ * of the host, so both read the same data.
+ *
+ * Build and run from this directory:
+ *   python3 RtcDueRcf_TzTableGen.py Europe/Berlin America/New_York Pacific/Auckland Europe/London \
+ *       Asia/Tokyo America/Sao_Paulo Europe/Moscow > TzTables_test.h
+ *   g++ -std=c++11 -O2 -I../../src ../../src/RtcDueRcf_TzTable.cpp RtcDueRcf_TzTable_test.cpp -o tz_test && ./tz_test
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "TzTables_test.h"
+
+namespace {
+
+static_assert(sizeof(std::time_t) == 8, "The host test requires a 64 bit time_t.");
+
+constexpr std::time_t BEGIN = 946684800;  // 1st of January 2000 00:00:00h UTC
+constexpr std::time_t END = 4102444800;   // 1st of January 2100 00:00:00h UTC
+
+/* Compare the lookup of utc against localtime_r(). */
+void check(const RtcDueRcf_TzTable& table, const std::time_t utc) {
+  std::time_t validFrom;
+  std::time_t validUntil;
+  const RtcDueRcf_TzTable::Type& type = table.lookup(utc, validFrom, validUntil);
+  std::tm expected;
+  localtime_r(&utc, &expected);
+  if(type.offset != -expected.tm_gmtoff || type.isdst != expected.tm_isdst) {
+    printf("%s %lld: offset %d isdst %d, expected %ld %d\n", table.name, static_cast<long long>(utc),
+        type.offset, type.isdst, -expected.tm_gmtoff, expected.tm_isdst);
+    assert(false);
+  }
+  assert(validFrom <= utc && utc < validUntil);
+}
+
+void testTable(const RtcDueRcf_TzTable& table) {
+  printf("--- %s %s\n", __FUNCTION__, table.name);
+  setenv("TZ", table.name, 1);
+  tzset();
+
+  // Walk from transition to transition and check the seconds around them.
+  size_t transitions = 0;
+  std::time_t utc = BEGIN;
+  while(utc < END) {
+    std::time_t validFrom;
+    std::time_t validUntil;
+    table.lookup(utc, validFrom, validUntil);
+    check(table, utc);
+    if(validUntil >= END) {
+      break;
+    }
+    check(table, validUntil - 1);
+    check(table, validUntil);
+    check(table, validUntil + 1);
+    utc = validUntil;
+    transitions++;
+  }
+  assert(transitions == table.transitionCount);
+
+  // The century with a stride that hits all times of the day.
+  for(std::time_t t = BEGIN; t < END; t += 3 * 3600 + 37) {
+    check(table, t);
+  }
+
+  printf("  %u transitions\n", static_cast<unsigned>(table.transitionCount));
+}
+
+} // anonymous namespace
+
+int main() {
+  using namespace TZ::TABLES;
+  testTable(Europe_Berlin);
+  testTable(America_New_York);
+  testTable(Pacific_Auckland);
+  testTable(Europe_London);
+  testTable(Asia_Tokyo);
+  testTable(America_Sao_Paulo);
+  testTable(Europe_Moscow);
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "RtcRegsBatchDecoder.h"
+#include "../../src/RtcDueRcf_Regs.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int32_t SECSPERDAY = 86400;
+
+/* Packed bcd to binary. */
+inline uint32_t bcdToBin(const uint32_t bcd) {
+  return bcd - 6 * (bcd >> 4);
+}
+
+/*
+ * 24-hrs representation of the hour field. In 12-hrs mode, 12AM is
+ * midnight and 12PM is noon.
+ */
+inline uint32_t hour24(const uint32_t timeReg, const uint32_t mode) {
+  const uint32_t hour = bcdToBin((timeReg >> 16) & 0x3F);
+  const uint32_t pm = (timeReg >> 22) & mode;
+  return hour - 12 * (mode & ((hour + 4) >> 4)) + 12 * pm;
+}
+
+inline uint32_t secondsOfDay(const uint32_t timeReg, const uint32_t mode) {
+  return hour24(timeReg, mode) * 3600 + bcdToBin((timeReg >> 8) & 0x7F) * 60
+      + bcdToBin(timeReg & 0x7F);
+}
+
+inline uint32_t year(const uint32_t calReg) {
+  return bcdToBin(calReg & 0x7F) * 100 + bcdToBin((calReg >> 8) & 0xFF);
+}
+
+inline uint32_t month(const uint32_t calReg) {
+  return bcdToBin((calReg >> 16) & 0x1F);
+}
+
+inline uint32_t day(const uint32_t calReg) {
+  return bcdToBin((calReg >> 24) & 0x3F);
+}
+
+/*
+ * days_from_civil without the era split, valid for years >= 1. The
+ * divisions are by constants, hence become multiplications, like in
+ * the SIMD variant.
+ */
+inline int32_t daysFromCivil(const uint32_t calReg) {
+  const uint32_t m = month(calReg);
+  const uint32_t janFeb = m <= 2;
+  const uint32_t y = year(calReg) - janFeb;
+  const uint32_t mp = m - 3 + 12 * janFeb;  // March based month [0..11]
+  const uint32_t doy = (153 * mp + 2) / 5 + day(calReg) - 1;
+  return static_cast<int32_t>(365 * y + y / 4 - y / 100 + y / 400 + doy) - 719468;
+}
+
+inline uint32_t modeAt(const uint8_t* rtc12HrsModes, size_t i) {
+  return rtc12HrsModes ? rtc12HrsModes[i] & 1 : 0;
+}
+
+#ifdef __AVX2__
+
+inline __m256i bcdToBin(const __m256i bcd) {
+  const __m256i tens = _mm256_srli_epi32(bcd, 4);
+  return _mm256_sub_epi32(bcd, _mm256_add_epi32(_mm256_slli_epi32(tens, 2), _mm256_slli_epi32(tens, 1)));
+}
+
+inline __m256i field(const __m256i reg, const int shift, const int mask) {
+  return _mm256_and_si256(_mm256_srli_epi32(reg, shift), _mm256_set1_epi32(mask));
+}
+
+inline __m256i mulConst(const __m256i x, const int c) {
+  return _mm256_mullo_epi32(x, _mm256_set1_epi32(c));
+}
+
+/* Decode 8 records. */
+inline void toTimeStamps8(const uint32_t* timeRegs, const uint32_t* calRegs, const __m256i mode,
+    int64_t* timeStamps, const __m256i stdOffset, const __m256i dstOffset) {
+  const __m256i timeReg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(timeRegs));
+  const __m256i calReg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(calRegs));
+  const __m256i one = _mm256_set1_epi32(1);
+
+  // Time of day.
+  const __m256i hour = bcdToBin(field(timeReg, 16, 0x3F));
+  const __m256i pm = _mm256_and_si256(_mm256_srli_epi32(timeReg, 22), mode);
+  const __m256i hour12 = _mm256_and_si256(mode, _mm256_srli_epi32(_mm256_add_epi32(hour, _mm256_set1_epi32(4)), 4));
+  const __m256i hour24 = _mm256_add_epi32(hour, mulConst(_mm256_sub_epi32(pm, hour12), 12));
+  const __m256i secondsOfDay = _mm256_add_epi32(_mm256_add_epi32(mulConst(hour24, 3600),
+      mulConst(bcdToBin(field(timeReg, 8, 0x7F)), 60)), bcdToBin(field(timeReg, 0, 0x7F)));
+
+  // days_from_civil
+  const __m256i m = bcdToBin(field(calReg, 16, 0x1F));
+  const __m256i janFeb = _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(3), m), one);
+  const __m256i y = _mm256_sub_epi32(_mm256_add_epi32(mulConst(bcdToBin(field(calReg, 0, 0x7F)), 100),
+      bcdToBin(field(calReg, 8, 0xFF))), janFeb);
+  const __m256i mp = _mm256_add_epi32(_mm256_sub_epi32(m, _mm256_set1_epi32(3)), mulConst(janFeb, 12));
+  // x / 5 == (x * 52429) >> 18 for x < 81920; x / 100 == (x * 5243) >> 19 for x < 43699
+  const __m256i doy = _mm256_add_epi32(_mm256_srli_epi32(mulConst(_mm256_add_epi32(mulConst(mp, 153),
+      _mm256_set1_epi32(2)), 52429), 18), _mm256_sub_epi32(bcdToBin(field(calReg, 24, 0x3F)), one));
+  const __m256i centuries = _mm256_srli_epi32(mulConst(y, 5243), 19);
+  const __m256i days = _mm256_sub_epi32(_mm256_add_epi32(_mm256_add_epi32(mulConst(y, 365),
+      _mm256_srli_epi32(y, 2)), _mm256_add_epi32(_mm256_sub_epi32(_mm256_srli_epi32(centuries, 2), centuries), doy)),
+      _mm256_set1_epi32(719468));
+
+  // Local to UTC
+  const __m256i offset = _mm256_blendv_epi8(stdOffset, dstOffset, _mm256_cmpeq_epi32(mode, one));
+  const __m256i seconds = _mm256_add_epi32(secondsOfDay, offset);
+
+  // Widen to 64 bit.
+  const __m256i secsPerDay = _mm256_set1_epi64x(SECSPERDAY);
+  const __m256i lo = _mm256_add_epi64(_mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(days)), secsPerDay),
+      _mm256_cvtepi32_epi64(_mm256_castsi256_si128(seconds)));
+  const __m256i hi = _mm256_add_epi64(_mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(days, 1)), secsPerDay),
+      _mm256_cvtepi32_epi64(_mm256_extracti128_si256(seconds, 1)));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(timeStamps), lo);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(timeStamps + 4), hi);
+}
+
+#endif // __AVX2__
+
+} // anonymous namespace
+
+namespace RtcRegsBatchDecoder {
+
+void toTimeStampsScalar(const uint32_t* timeRegs, const uint32_t* calRegs, const uint8_t* rtc12HrsModes,
+    size_t count, int64_t* timeStamps, int32_t stdOffset, int32_t dstOffset) {
+  for(size_t i = 0; i < count; i++) {
+    const uint32_t mode = modeAt(rtc12HrsModes, i);
+    const int32_t offset = mode ? dstOffset : stdOffset;
+    timeStamps[i] = static_cast<int64_t>(daysFromCivil(calRegs[i])) * SECSPERDAY
+        + static_cast<int32_t>(secondsOfDay(timeRegs[i], mode)) + offset;
+  }
+}
+
+void toTimeStamps(const uint32_t* timeRegs, const uint32_t* calRegs, const uint8_t* rtc12HrsModes,
+    size_t count, int64_t* timeStamps, int32_t stdOffset, int32_t dstOffset) {
+  size_t i = 0;
+#ifdef __AVX2__
+  const __m256i stdOffsets = _mm256_set1_epi32(stdOffset);
+  const __m256i dstOffsets = _mm256_set1_epi32(dstOffset);
+  for(; i + 8 <= count; i += 8) {
+    const __m256i mode = rtc12HrsModes ? _mm256_and_si256(_mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(rtc12HrsModes + i))), _mm256_set1_epi32(1))
+        : _mm256_setzero_si256();
+    toTimeStamps8(timeRegs + i, calRegs + i, mode, timeStamps + i, stdOffsets, dstOffsets);
+  }
+#endif
+  toTimeStampsScalar(timeRegs + i, calRegs + i, rtc12HrsModes ? rtc12HrsModes + i : nullptr,
+      count - i, timeStamps + i, stdOffset, dstOffset);
+}
+
+void toTm(const uint32_t* timeRegs, const uint32_t* calRegs, const uint8_t* rtc12HrsModes,
+    size_t count, std::tm* times) {
+  for(size_t i = 0; i < count; i++) {
+    const uint32_t timeReg = timeRegs[i];
+    const uint32_t calReg = calRegs[i];
+    const uint32_t mode = modeAt(rtc12HrsModes, i);
+    std::tm& time = times[i];
+    time.tm_sec = bcdToBin(timeReg & 0x7F);
+    time.tm_min = bcdToBin((timeReg >> 8) & 0x7F);
+    time.tm_hour = hour24(timeReg, mode);
+    time.tm_mday = day(calReg);
+    time.tm_mon = month(calReg) - 1;
+    time.tm_year = year(calReg) - 1900;
+    time.tm_wday = ((calReg >> 21) & 0x07) - 1;
+    time.tm_yday = daysFromCivil(calReg) - Sam3XA::RtcRegsConstexpr::daysFromCivil(year(calReg), 1, 1);
+    time.tm_isdst = mode;
+  }
+}
+
+} // namespace RtcRegsBatchDecoder
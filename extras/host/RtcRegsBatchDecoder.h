@@ -0,0 +1,86 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_EXTRAS_HOST_RTCREGSBATCHDECODER_H_
+#define RTCDUERCF_EXTRAS_HOST_RTCREGSBATCHDECODER_H_
+
+/*
+ * Host side (Linux, Windows, macOS) decoder for RTC_TIMR / RTC_CALR
+ * register contents that were logged on the Arduino Due. Not part of
+ * the Arduino library build.
+ *
+ * The register arrays are passed as separate arrays (structure of
+ * arrays), so that they can be loaded into SIMD registers directly.
+ * When compiled with AVX2 enabled (e.g. -mavx2 or -march=native), 8
+ * records are decoded at once. Otherwise a branch free scalar loop is
+ * used that the compiler can auto vectorize for SSE.
+ *
+ * The RTC hour mode is taken as daylight savings flag, like the
+ * library does it:
+ *    0: RTC runs in 24-hrs mode, standard time.
+ *    1: RTC runs in 12-hrs mode, daylight savings time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ctime>
+
+namespace RtcRegsBatchDecoder {
+
+/**
+ * Decode register contents to time stamps.
+ *
+ * @param timeRegs Contents of the RTC_TIMR register.
+ * @param calRegs Contents of the RTC_CALR register.
+ * @param rtc12HrsModes The hour mode (0 or 1) of each record. May be nullptr,
+ *    if the RTC always ran in 24-hrs mode.
+ * @param count Number of records.
+ * @param timeStamps The resulting time stamps.
+ * @param stdOffset Seconds to be added to the local standard time to get
+ *    UTC. Sign like in POSIX TZ strings and newlib: positive west of
+ *    Greenwich. E.g. -3600 for CET. Pass 0 to get local time stamps.
+ * @param dstOffset Same for the daylight savings time. E.g. -7200 for CEST.
+ */
+void toTimeStamps(const uint32_t* timeRegs, const uint32_t* calRegs, const uint8_t* rtc12HrsModes,
+    size_t count, int64_t* timeStamps, int32_t stdOffset = 0, int32_t dstOffset = 0);
+
+/**
+ * Same as toTimeStamps(), but without SIMD. Used for the remainder of
+ * toTimeStamps() and as reference.
+ */
+void toTimeStampsScalar(const uint32_t* timeRegs, const uint32_t* calRegs, const uint8_t* rtc12HrsModes,
+    size_t count, int64_t* timeStamps, int32_t stdOffset = 0, int32_t dstOffset = 0);
+
+/**
+ * Decode register contents to std::tm. tm_isdst is set to the hour mode,
+ * tm_wday is taken from the RTC_CALR day field, tm_yday is calculated.
+ */
+void toTm(const uint32_t* timeRegs, const uint32_t* calRegs, const uint8_t* rtc12HrsModes,
+    size_t count, std::tm* times);
+
+} // namespace RtcRegsBatchDecoder
+
+#endif /* RTCDUERCF_EXTRAS_HOST_RTCREGSBATCHDECODER_H_ */
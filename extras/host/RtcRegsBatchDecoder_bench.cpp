@@ -0,0 +1,132 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+/*
+ * Check and throughput benchmark for the RtcRegsBatchDecoder.
+ *
+ * Build and run from this directory:
+ *   g++ -std=c++11 -O2 -march=native RtcRegsBatchDecoder.cpp RtcRegsBatchDecoder_bench.cpp -o bench && ./bench
+ *
+ * Without -march=native (or -mavx2) the scalar path is measured only.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "RtcRegsBatchDecoder.h"
+#include "../../src/RtcDueRcf_Regs.h"
+
+namespace {
+
+using namespace Sam3XA::RtcRegsConstexpr;
+
+constexpr int32_t CET = -3600;
+constexpr int32_t CEST = -7200;
+
+/* Civil date from days since 1970-01-01. */
+void civilFromDays(int64_t days, uint32_t& year, uint32_t& month, uint32_t& day) {
+  days += 719468;
+  const int64_t era = days / 146097;
+  const uint32_t doe = static_cast<uint32_t>(days - era * 146097);
+  const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const uint32_t mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  year = static_cast<uint32_t>(yoe + era * 400) + (month <= 2);
+}
+
+struct Records {
+  std::vector<uint32_t> timeRegs;
+  std::vector<uint32_t> calRegs;
+  std::vector<uint8_t> modes;
+  std::vector<int64_t> expected;
+};
+
+/* Records from 1900 to 2099 with odd steps, every 3rd in 12-hrs mode. */
+void makeRecords(Records& records, size_t count) {
+  const int64_t begin = -2208988800; // 1900-01-01 00:00:00 UTC
+  const int64_t end = 4102444800 - 2 * 3600;
+  const int64_t step = (end - begin) / static_cast<int64_t>(count);
+  int64_t utc = begin + 7200;
+  for(size_t i = 0; i < count; i++, utc += step) {
+    const uint8_t mode = i % 3 == 0;
+    const int64_t local = utc - (mode ? CEST : CET);
+    const int64_t days = local >= 0 ? local / 86400 : (local - 86399) / 86400;
+    const uint32_t secs = static_cast<uint32_t>(local - days * 86400);
+    uint32_t year, month, day;
+    civilFromDays(days, year, month, day);
+    records.timeRegs.push_back(timeReg(secs / 3600, secs / 60 % 60, secs % 60, mode));
+    records.calRegs.push_back(calReg(year, month, day));
+    records.modes.push_back(mode);
+    records.expected.push_back(utc);
+  }
+}
+
+template<typename DECODER> double recordsPerSecond(const Records& records, std::vector<int64_t>& result,
+    DECODER decoder) {
+  constexpr int RUNS = 10;
+  const auto start = std::chrono::steady_clock::now();
+  for(int run = 0; run < RUNS; run++) {
+    decoder(records.timeRegs.data(), records.calRegs.data(), records.modes.data(),
+        records.timeRegs.size(), result.data(), CET, CEST);
+  }
+  const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+  return RUNS * records.timeRegs.size() / duration.count();
+}
+
+} // anonymous namespace
+
+int main() {
+  constexpr size_t N = 10000003; // Not a multiple of 8, to run the remainder too.
+  Records records;
+  makeRecords(records, N);
+  std::vector<int64_t> result(N);
+
+  const double scalar = recordsPerSecond(records, result, RtcRegsBatchDecoder::toTimeStampsScalar);
+  assert(result == records.expected);
+  const double batch = recordsPerSecond(records, result, RtcRegsBatchDecoder::toTimeStamps);
+  assert(result == records.expected);
+
+  std::vector<std::tm> times(1000);
+  RtcRegsBatchDecoder::toTm(records.timeRegs.data(), records.calRegs.data(), records.modes.data(),
+      times.size(), times.data());
+  for(size_t i = 0; i < times.size(); i++) {
+    std::tm time = times[i];
+    const int64_t expectedLocal = records.expected[i] - (records.modes[i] ? CEST : CET);
+    assert(timegm(&time) == expectedLocal);
+    assert(time.tm_wday == times[i].tm_wday && time.tm_yday == times[i].tm_yday);
+  }
+
+#ifdef __AVX2__
+  const char* const simd = "AVX2";
+#else
+  const char* const simd = "none";
+#endif
+  printf("records: %zu, SIMD: %s\n", N, simd);
+  printf("toTimeStampsScalar: %.1f M records/s\n", scalar / 1e6);
+  printf("toTimeStamps:       %.1f M records/s\n", batch / 1e6);
+  return 0;
+}
@@ -23,10 +23,13 @@
 */
 
 #include <assert.h>
+#include <atomic>
 #include <Arduino.h>
 #include "TM.h"
 #include "internal/core-sam-GapClose.h"
 #include "internal/RtcTime.h"
+#include "internal/RtcSnapshot.h"
+#include "internal/RtcTimeZone.h"
 #include "internal/RtcDueRcf_RtcState.h"
 #include "RtcDueRcf.h"
 
@@ -50,22 +53,55 @@
 #define DEBUG_RTC_ALARM false
 #endif
 
-#if RTC_MEASURE_ACKUPD || MEASURE_DST_RTC_REQUEST || DEBUG_DST_REQUEST || DEBUG_GET_TIME
-#include <Arduino.h>
+/*
+ * Minimum time in microseconds between the RTC update acknowledge and
+ * the release of the RTC by setTimeAligned(). Covers the encoding of the
+ * time. Otherwise the next reference second boundary is taken.
+ */
+#ifndef RTC_ALIGN_MARGIN_US
+#define RTC_ALIGN_MARGIN_US 2000
 #endif
 
-namespace {
+/*
+ * Maximum time in microseconds that setTimeAligned() waits for the RTC
+ * update acknowledge. The RTC acknowledges upon its next second.
+ */
+#ifndef RTC_ALIGN_ACK_TIMEOUT_US
+#define RTC_ALIGN_ACK_TIMEOUT_US 1100000
+#endif
 
-#if DEBUG_SET_TIME
+/*
+ * setTimeAligned() waits with interrupts disabled for this time in
+ * microseconds before releasing the RTC, so that no interrupt delays
+ * the release.
+ */
+#ifndef RTC_ALIGN_SPIN_US
+#define RTC_ALIGN_SPIN_US 200
+#endif
 
-const char* const szSET_TIME_REQUEST[] = {
-    "NO_REQUEST",
-    "REQUEST",
-    "DST_RTC_REQUEST"
-};
+/*
+ * correctDrift() doesn't request a step within this time in
+ * microseconds before the next RTC second transition, because the step
+ * is written upon that transition.
+ */
+#ifndef RTC_DRIFT_LATEST_REQUEST_US
+#define RTC_DRIFT_LATEST_REQUEST_US 800000
+#endif
 
+/*
+ * Maximum deviation of the RTC from a reference time in seconds, that
+ * is taken as drift by addReferenceTime().
+ */
+#ifndef RTC_DRIFT_MAX_OFFSET_S
+#define RTC_DRIFT_MAX_OFFSET_S 1000
 #endif
 
+#if MEASURE_DST_RTC_REQUEST || DEBUG_DST_REQUEST || DEBUG_GET_TIME
+#include <Arduino.h>
+#endif
+
+namespace {
+
 /**
  * Substitute for the original api function RTC_GetHourMode()
  * from rtc.h, which has a bug.
@@ -91,14 +127,32 @@ void RTC_Handler (void) {
  * be only one object RtcDueRcf::clock.
  */
 RtcDueRcf::RtcDueRcf()
-  : mSetTimeRequest(SET_TIME_REQUEST::NO_REQUEST)
+  : mDstRequest(false)
+  , mTimeZoneGeneration(0)
+  , mEventDrivenDstCheck(false)
+  , mRtcUpdateRequested(false)
+  , mAlignRequest(false)
+  , mAlignAcknowledged(false)
+  , mAlignedTicket(0)
+  , mAlignMeasurePending(false)
+  , mAlignMeasured(false)
+  , mAlignReleaseMicros(0)
+  , mAlignmentError(0)
+  , mReadRetryLimit(RTC_READ_RETRY_LIMIT)
   , mSecondCallback(nullptr)
   , mSecondCallbackPararm(nullptr)
   , mAlarmCallback(nullptr)
   , mAlarmCallbackPararm(nullptr)
-#if RTC_MEASURE_ACKUPD
-  , mTimestampACKUPD(0)
-#endif
+  , mCommitCallback(nullptr)
+  , mCommitCallbackParam(nullptr)
+  , mSetTimeTicket(0)
+  , mCommittedTicket(0)
+  , mSetTimeRequestMicros{0, 0}
+  , mSupersededRequests(0)
+  , mSupersededDstRequests(0)
+  , mCommitLatency(0)
+  , mDstRequestMicros(0)
+  , mZoneCount(0)
 {
 }
 
@@ -117,24 +171,21 @@ void RtcDueRcf::begin(const char* timezone, const uint8_t irqPrio, const RTC_OSC
 
   NVIC_DisableIRQ(RTC_IRQn);
   NVIC_ClearPendingIRQ(RTC_IRQn);
+  mTimeSeqlock.invalidate();
   NVIC_SetPriority(RTC_IRQn, irqPrio);
   RTC_EnableIt(RTC, RTC_IER_SECEN | RTC_IER_ACKEN);
   NVIC_EnableIRQ(RTC_IRQn);
 }
 
 /**
- * Place the time in the mSetTimeCache, set the mSetTimeRequest
- * to SET_TIME_REQUEST::REQUEST.
- * This update request will fire an interrupt, once the RTC
- * is ready to accept a new time and date. The RTC_Handler
- * will then pickup the time and date from the mSetTimeCache
- * and write it to the RTC.
+ * Place the time in one of the mSetTimeSlots and publish it by
+ * a new generation.
+ * The RTC_Handler requests the update, that will fire an interrupt,
+ * once the RTC is ready to accept a new time and date. The RTC_Handler
+ * will then pickup the time and date of the latest generation and
+ * write it to the RTC.
  */
 bool RtcDueRcf::setTime(const std::tm &localTime) {
-  if(localTime.tm_year >= TM::make_tm_year(2000)) {
-    RTC->RTC_CR |= (RTC_CR_UPDTIM | RTC_CR_UPDCAL);
-    RTC_DisableIt(RTC, RTC_IER_ACKEN);
-
 #if DEBUG_SET_TIME
   	Serial.print("RtcDueRcf::");
 		Serial.print(__FUNCTION__);
@@ -142,46 +193,12 @@ bool RtcDueRcf::setTime(const std::tm &localTime) {
 		print_tm(Serial, localTime, true);
 		Serial.println();
 #endif
-
-    /**
-     * Call mktime in order to fix tm_yday, tm_isdst and the hour,
-     * depending on whether the time is within daylight saving
-     * period or not.
-     */
-     std::tm buffer = localTime;
-     const time_t localTime = mktime(&buffer);
-
-    // Fill cache with time.
-    if(mSetTimeCache.set(buffer)) {
-  #if DEBUG_DST_REQUEST
-        Serial.print("setTime");
-  #endif
-
-      if(not mSetTimeRequest) {
-        mSetTimeRequest = SET_TIME_REQUEST::REQUEST;
-  #if DEBUG_DST_REQUEST
-        Serial.println(", REQUEST");
-  #endif
-        RTC->RTC_CR |= (RTC_CR_UPDTIM | RTC_CR_UPDCAL);
-      } else {
-  #if DEBUG_DST_REQUEST
-        Serial.println();
-  #endif
-      }
-
-      RTC_EnableIt(RTC, RTC_IER_ACKEN);
-      return true;
-    }
-    RTC_EnableIt(RTC, RTC_IER_ACKEN);
-  }
-  return false;
+  // Validate before touching the RTC.
+  RtcDueRcf_Transaction transaction;
+  return transaction.setTime(localTime) && commit(transaction);
 }
 
 bool RtcDueRcf::setTime_(const std::tm &localTime) {
-  if(localTime.tm_year >= TM::make_tm_year(2000)) {
-    RTC->RTC_CR |= (RTC_CR_UPDTIM | RTC_CR_UPDCAL);
-    RTC_DisableIt(RTC, RTC_IER_ACKEN);
-
 #if DEBUG_SET_TIME
   	Serial.print("RtcDueRcf::");
 		Serial.print(__FUNCTION__);
@@ -189,117 +206,401 @@ bool RtcDueRcf::setTime_(const std::tm &localTime) {
 		print_tm(Serial, localTime, true);
 		Serial.println();
 #endif
+  // Validate before touching the RTC.
+  RtcDueRcf_Transaction transaction;
+  return transaction.setTime_(localTime) && commit(transaction);
+}
+
+bool RtcDueRcf::setTimeRegs(const uint32_t timeReg, const uint32_t calReg, const uint32_t rtc12HrsMode) {
+  // Validate before touching the RTC.
+  Sam3XA::RtcSetTimeCache cache;
+  if(cache.set(timeReg, calReg, rtc12HrsMode)) {
+    requestSetTime(cache);
+    return true;
+  }
+  return false;
+}
+
+bool RtcDueRcf::commit(const RtcDueRcf_Transaction& transaction) {
+  if(transaction.hasTime()) {
+    requestSetTime(transaction.mCache);
+    return true;
+  }
+  return false;
+}
+
+void RtcDueRcf::requestSetTime(const Sam3XA::RtcSetTimeCache& cache) {
+  // Fill the slot that the RTC interrupt doesn't pick, then publish it
+  // by the generation. No interrupt needs to be disabled.
+  const uint32_t generation = mSetTimeTicket + 1;
+  mSetTimeSlots[generation & 1] = cache;
+  if(isSetTimePending()) {
+    // The staged alarm of the superseded generation must not get lost.
+    // If that generation is committed meanwhile, the alarm is just
+    // written twice.
+    mSetTimeSlots[generation & 1].inheritAlarm(mSetTimeSlots[mSetTimeTicket & 1]);
+  }
+  mSetTimeRequestMicros[generation & 1] = micros();
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+  mSetTimeTicket = generation;
+#if DEBUG_DST_REQUEST
+  Serial.println("setTime, REQUEST");
+#endif
+  // Let the RTC interrupt request the RTC update.
+  NVIC_SetPendingIRQ(RTC_IRQn);
+}
+
+/**
+ * Align the RTC second transitions to the reference:
+ *  1. Request the update like setTime() does, but the RTC interrupt
+ *    leaves the ACKUPD flag set and disables the ACKUPD interrupt.
+ *  2. Once acknowledged, the RTC is stopped. Take the first reference
+ *    second boundary that leaves RTC_ALIGN_MARGIN_US for encoding the
+ *    reference time of that boundary.
+ *  3. Write the time to the RTC exactly upon that boundary. Then the
+ *    RTC continues counting in phase with the reference.
+ */
+bool RtcDueRcf::setTimeAligned(std::time_t utcTimestamp, uint32_t subsecondOffset) {
+  // Begin of the reference second utcTimestamp in terms of micros().
+  const uint32_t referenceMicros = micros() - subsecondOffset;
+#if DEBUG_SET_TIME
+	Serial.print("RtcDueRcf::");
+	Serial.print(__FUNCTION__);
+	Serial.print(' ');
+	Serial.println(utcTimestamp);
+#endif
+  Sam3XA::RtcTime rtcTime;
+  rtcTime.setUtc(utcTimestamp);
+  Sam3XA::RtcSetTimeCache cache;
+  if(subsecondOffset >= 1000000 || rtcTime.year() < 2000 || not cache.set(rtcTime)) {
+    return false;
+  }
 
-    // Fill cache with time.
-    if(mSetTimeCache.set(localTime)) {
-  #if DEBUG_DST_REQUEST
-        Serial.print("setTime");
-  #endif
-
-      if(not mSetTimeRequest) {
-        mSetTimeRequest = SET_TIME_REQUEST::REQUEST;
-  #if DEBUG_DST_REQUEST
-        Serial.println(", REQUEST");
-  #endif
-        RTC->RTC_CR |= (RTC_CR_UPDTIM | RTC_CR_UPDCAL);
-      } else {
-  #if DEBUG_DST_REQUEST
-        Serial.println();
-  #endif
+  const uint32_t generation = mSetTimeTicket + 1;
+  mAlignedTicket = generation;
+  mAlignAcknowledged = false;
+  mAlignMeasured = false;
+  mAlignRequest = true;
+  // Until aligned, the time is delivered from the request.
+  requestSetTime(cache);
+
+  const uint32_t start = micros();
+  while(not mAlignAcknowledged) {
+    if(micros() - start > RTC_ALIGN_ACK_TIMEOUT_US) {
+      const uint32_t primask = __get_PRIMASK();
+      __disable_irq();
+      const bool acknowledged = mAlignAcknowledged;
+      mAlignRequest = false;
+      if(not acknowledged) {
+        // Withdraw the request. Otherwise the RTC interrupt would commit
+        // the time of the call later on.
+        advanceCommittedTicket(generation);
+        if(not mDstRequest) {
+          RTC_CancelTimeAndDateUpdate(RTC);
+          mRtcUpdateRequested = false;
+        }
       }
-      RTC_EnableIt(RTC, RTC_IER_ACKEN);
-      return true;
+      __set_PRIMASK(primask);
+      if(not acknowledged) {
+        return false;
+      }
+    }
+  }
+
+  const uint32_t elapsed = micros() + RTC_ALIGN_MARGIN_US - referenceMicros;
+  const uint32_t seconds = elapsed / 1000000 + 1;
+  const uint32_t releaseMicros = referenceMicros + seconds * 1000000;
+  rtcTime.setUtc(utcTimestamp + seconds);
+  // Keep an alarm, that has been carried forward from a pending commit().
+  cache = mSetTimeSlots[generation & 1];
+  cache.set(rtcTime);
+
+  while(static_cast<int32_t>(micros() - (releaseMicros - RTC_ALIGN_SPIN_US)) < 0) {
+  }
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  while(static_cast<int32_t>(micros() - releaseMicros) < 0) {
+  }
+  const bool result = cache.writeToRtc();
+  if(result) {
+    mSetTimeSlots[generation & 1] = cache;
+    mCommitLatency = micros() - mSetTimeRequestMicros[generation & 1];
+    advanceCommittedTicket(generation);
+    // Like a commit by the RTC interrupt, the time supersedes a pending
+    // daylight savings request. It is checked upon the next second.
+    supersedeDstRequest();
+    mAlignReleaseMicros = releaseMicros;
+    mAlignMeasurePending = true;
+    mRtcUpdateRequested = false;
+    mDstTransitionCache.invalidate();
+    if(mEventDrivenDstCheck) {
+      RTC_SelectWakeup(RTC, RTC_WAKEUP_SECOND);
     }
-    RTC_EnableIt(RTC, RTC_IER_ACKEN);
+  }
+  mAlignRequest = false;
+  __set_PRIMASK(primask);
+  // Otherwise the RTC interrupt commits without alignment.
+  RTC_EnableIt(RTC, RTC_IER_ACKEN);
+
+  if(result && mCommitCallback) {
+    (*mCommitCallback)(mCommitCallbackParam, mCommitLatency);
+  }
+  return result;
+}
+
+void RtcDueRcf::advanceCommittedTicket(const uint32_t generation) {
+  const int32_t advance = static_cast<int32_t>(generation - mCommittedTicket);
+  if(advance > 0) {
+    mSupersededRequests = mSupersededRequests + (advance - 1);
+    mCommittedTicket = generation;
+  }
+}
+
+void RtcDueRcf::supersedeDstRequest() {
+  if(mDstRequest) {
+    mDstRequest = false;
+    mSupersededDstRequests = mSupersededDstRequests + 1;
+  }
+}
+
+bool RtcDueRcf::getAlignmentError(int32_t& errorMicros) const {
+  if(mAlignMeasured) {
+    errorMicros = mAlignmentError;
+    return true;
   }
   return false;
 }
 
+void RtcDueRcf::requestRtcUpdate() {
+  if(not mRtcUpdateRequested) {
+    mRtcUpdateRequested = true;
+    RTC_RequestTimeAndDateUpdate(RTC);
+  }
+}
+
 /**
  * Check daylight savings transition, and update the RTC accordingly.
  * Adjusting the RTC to local daylight saving time ensures, that
  * the RTC alarm happens at the expected time.
- * When compiled with option -Os, the function takes up to 20us to
- * execute. This function is called once a second.
+ * This function is called once a second. The daylight savings rules
+ * are evaluated only when the cached next transition has been reached,
+ * the RTC time has been set or the time zone has changed. When compiled
+ * with option -Os, that takes up to 20us. Otherwise it's a single
+ * compare against the cached transition.
+ *
+ * A pending set time request of the user is not touched. The time
+ * that it sets is checked upon the second after its commit.
  */
-void RtcDueRcf::RtcDueRcf_DstChecker() {
-  if(mSetTimeRequest != SET_TIME_REQUEST::DST_RTC_REQUEST) {
+void RtcDueRcf::RtcDueRcf_DstChecker(const Sam3XA::RtcTime& rtcTime) {
+  const uint32_t timeZoneGeneration = mTimeZoneGeneration;
+  if(not mDstRequest && not isSetTimePending()) {
 #if MEASURE_DST_RTC_REQUEST
+    const bool due = mDstTransitionCache.isCheckDue(rtcTime, timeZoneGeneration);
     const uint32_t start = micros();
 #endif
     Sam3XA::RtcTime dueTimeAndDate;
-    const bool request = dueTimeAndDate.isDstRtcRequest();
+    const bool request = mDstTransitionCache.check(rtcTime, timeZoneGeneration, dueTimeAndDate);
     if(request) {
       // Fill cache with time.
-      mSetTimeCache.set(dueTimeAndDate);
+      mDstCache.set(dueTimeAndDate);
+      mDstRequestMicros = micros();
+      mDstRequest = true;
 #if DEBUG_DST_REQUEST
       Serial.print(__FUNCTION__);
+      Serial.println(", DST_RTC_REQUEST");
 #endif
-      if(not mSetTimeRequest) {
-        mSetTimeRequest = SET_TIME_REQUEST::DST_RTC_REQUEST;
-#if DEBUG_DST_REQUEST
-        Serial.println(", DST_RTC_REQUEST");
-#endif
-        RTC->RTC_CR |= (RTC_CR_UPDTIM | RTC_CR_UPDCAL);
-      } else {
-        mSetTimeRequest = SET_TIME_REQUEST::DST_RTC_REQUEST;
-#if DEBUG_DST_REQUEST
-        Serial.println(", DST_RTC_REQUEST");
-#endif
-      }
+      requestRtcUpdate();
     }
 #if MEASURE_DST_RTC_REQUEST
     const uint32_t diff = micros()-start;
     if(request) {
       Serial.print("DST_RTC_REQUEST (TRUE)  duration: ");
-    } else {
+      Serial.println(diff);
+    } else if(due) {
       Serial.print("DST_RTC_REQUEST (FALSE) duration: ");
+      Serial.println(diff);
     }
-    Serial.println(diff);
 #endif
   }
 }
 
+void RtcDueRcf::RtcDueRcf_SelectWakeup(const Sam3XA::RtcTime& rtcTime) {
+  // Requests, the alignment measurement and the second callback need
+  // the second interrupt.
+  const bool everySecond = not mEventDrivenDstCheck || mSecondCallback || mDstRequest
+      || mRtcUpdateRequested || isSetTimePending() || mAlignMeasurePending;
+  const uint32_t wakeup = everySecond ? RTC_WAKEUP_SECOND
+      : mDstTransitionCache.selectWakeup(rtcTime, mTimeZoneGeneration);
+  if(wakeup != RTC_WAKEUP_SECOND) {
+    // No second interrupt republishes the time. Let the readers fall
+    // back to the RTC registers.
+    mTimeSeqlock.invalidate();
+  }
+  RTC_SelectWakeup(RTC, wakeup);
+}
+
+void RtcDueRcf::setTimeZone(const RtcDueRcf_TimeZone& timeZone) {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  Sam3XA::RtcTimeZone::set(timeZone);
+  mTimeZoneGeneration = mTimeZoneGeneration + 1;
+  if(mEventDrivenDstCheck) {
+    RTC_SelectWakeup(RTC, RTC_WAKEUP_SECOND);
+  }
+  __set_PRIMASK(primask);
+}
+
+void RtcDueRcf::setEventDrivenDstCheck(const bool eventDriven) {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  mEventDrivenDstCheck = eventDriven;
+  // In event driven mode, the next second interrupt selects the wake up.
+  RTC_SelectWakeup(RTC, RTC_WAKEUP_SECOND);
+  __set_PRIMASK(primask);
+}
+
 /**
- * Pick the mSetTimeCache and write it to the RTC.
+ * Pick the latest set time request and write it to the RTC.
+ *
+ * The set time path is a state machine that is driven by the RTC
+ * interrupts only:
+ *  Request: setTime() places the time in one of the two mSetTimeSlots,
+ *    publishes it by a new generation (ticket) and pends the RTC
+ *    interrupt. The daylight savings check places the time in
+ *    mDstCache. In both cases the RTC interrupt requests the update.
+ *    The RTC stops counting and acknowledges within one second.
+ *  Commit: Upon the ACKUPD interrupt the latest generation is committed
+ *    to the RTC, which continues counting. Older generations that have
+ *    not been committed are superseded. A user request takes precedence
+ *    over a daylight savings request, because it is based on a newer
+ *    time. The daylight savings check is repeated for the new time upon
+ *    the next second, so a daylight savings adjustment isn't lost.
+ * Neither of them waits for the RTC.
  */
-void RtcDueRcf::RtcDueRcf_AckUpdHandler() {
-  if (mSetTimeRequest != SET_TIME_REQUEST::NO_REQUEST) {
+void RtcDueRcf::RtcDueRcf_AckUpdHandler(const uint32_t ackMicros) {
+  const uint32_t generation = mSetTimeTicket;
+  if (mAlignRequest && generation == mAlignedTicket) {
+    // setTimeAligned() writes the time. Keep the RTC stopped and
+    // ACKUPD set until then.
+    RTC_DisableIt(RTC, RTC_IDR_ACKDIS);
+    mAlignAcknowledged = true;
+    mTimeSeqlock.invalidate();
+    return;
+  }
+  if (generation != mCommittedTicket) {
 #if DEBUG_SET_TIME
   	Serial.print("RtcDueRcf::");
   	Serial.print(__FUNCTION__);
-  	Serial.print(' ');
-  	Serial.println(szSET_TIME_REQUEST[mSetTimeRequest]);
+  	Serial.println(" REQUEST");
 #endif
-    mSetTimeCache.writeToRtc();
-    mSetTimeRequest = SET_TIME_REQUEST::NO_REQUEST;
-#if DEBUG_DST_REQUEST
-    Serial.println("NO_REQUEST");
+    const uint32_t commitStart = micros();
+    if(mSetTimeSlots[generation & 1].writeToRtc()) {
+      const uint32_t commitEnd = micros();
+      mSetTrace.record(RtcDueRcf_SetTrace::REQUEST, mSetTimeRequestMicros[generation & 1], ackMicros,
+          commitEnd - commitStart);
+      supersedeDstRequest();
+      mCommitLatency = commitEnd - mSetTimeRequestMicros[generation & 1];
+      advanceCommittedTicket(generation);
+      if(mCommitCallback) {
+        (*mCommitCallback)(mCommitCallbackParam, mCommitLatency);
+      }
+    }
+  } else if (mDstRequest) {
+#if DEBUG_SET_TIME
+  	Serial.print("RtcDueRcf::");
+  	Serial.print(__FUNCTION__);
+  	Serial.println(" DST_RTC_REQUEST");
 #endif
+    const uint32_t commitStart = micros();
+    if(mDstCache.writeToRtc()) {
+      mSetTrace.record(RtcDueRcf_SetTrace::DST_RTC_REQUEST, mDstRequestMicros, ackMicros,
+          micros() - commitStart);
+      mDstRequest = false;
+    }
+  } else {
+    // Acknowledge without a pending request. Let the RTC continue.
+    RTC_CancelTimeAndDateUpdate(RTC);
   }
+  mRtcUpdateRequested = false;
+  // The published time is outdated until the next second interrupt.
+  mTimeSeqlock.invalidate();
+  // The transition has to be recalculated for the new time.
+  mDstTransitionCache.invalidate();
+  if(mEventDrivenDstCheck) {
+    RTC_SelectWakeup(RTC, RTC_WAKEUP_SECOND);
+  }
+#if DEBUG_DST_REQUEST
+  Serial.println("NO_REQUEST");
+#endif
 }
 
 /**
- * RtcDueRcf interrupt handler
+ * RtcDueRcf interrupt handler. There is no busy waiting for the
+ * RTC. The worst case execution time is given by the second interrupt
+ * (bounded register read, daylight savings check and the second
+ * callback) followed by the commit of a set time request (see
+ * RTC_CommitTimeAndDate()) and the alarm callback.
  */
 void RtcDueRcf::RtcDueRcf_Handler() {
   const uint32_t status = RTC->RTC_SR;
+  // The second and the time event flags are set, even if their
+  // interrupts are disabled. Such flags are stale.
+  const uint32_t enabled = RTC->RTC_IMR;
+  /* Set time request from thread level */
+  if (isSetTimePending()) {
+    requestRtcUpdate();
+  }
   /* Second increment interrupt */
-  if ((status & RTC_SR_SEC) == RTC_SR_SEC) {
-    RtcDueRcf_DstChecker();
+  if ((status & enabled & RTC_SR_SEC) == RTC_SR_SEC) {
+    // Latch the begin of the second as early as possible.
+    const uint32_t secondMicros = micros();
+    if(mAlignMeasurePending) {
+      // The RTC second lasts one second from the release.
+      mAlignmentError = static_cast<int32_t>(secondMicros - mAlignReleaseMicros - 1000000);
+      mAlignMeasurePending = false;
+      mAlignMeasured = true;
+    }
+    // Read the RTC once for publishing and for the daylight savings check.
+    Sam3XA::RtcSnapshot snapshot;
+    if(readFromRtc(snapshot)) {
+      Sam3XA::RtcTime rtcTime;
+      rtcTime.set(snapshot);
+      const Sam3XA::RtcDueRcf_RtcState state(Sam3XA::RtcSnapshot::validEntryRegister());
+      RtcDueRcf_DstChecker(rtcTime);
+      // Until committed, the daylight savings adjusted time is the valid one.
+      mTimeSeqlock.publish(not (state.isTimeValid() && state.isCalendarValid()) ? Sam3XA::RtcTime()
+          : mDstRequest ? mDstCache.toRtcTime() : rtcTime, secondMicros);
+      if(mEventDrivenDstCheck) {
+        RtcDueRcf_SelectWakeup(rtcTime);
+      }
+    } else {
+      // Daylight savings will be checked upon the next second.
+      mTimeSeqlock.invalidate();
+    }
     if (mSecondCallback) {
       (*mSecondCallback)(mSecondCallbackPararm);
     }
     RTC_ClearSCCR(RTC, RTC_SCCR_SECCLR);
   }
 
+  /* Time event interrupt. Enabled by the event driven daylight savings check only. */
+  if ((status & enabled & RTC_SR_TIMEV) == RTC_SR_TIMEV) {
+    RTC_ClearSCCR(RTC, RTC_SCCR_TIMCLR);
+    Sam3XA::RtcSnapshot snapshot;
+    if(readFromRtc(snapshot)) {
+      Sam3XA::RtcTime rtcTime;
+      rtcTime.set(snapshot);
+      RtcDueRcf_SelectWakeup(rtcTime);
+    } else {
+      // Daylight savings will be checked upon the next second.
+      RTC_SelectWakeup(RTC, RTC_WAKEUP_SECOND);
+    }
+  }
+
   /* Acknowledge for Update interrupt */
   if ((status & RTC_SR_ACKUPD) == RTC_SR_ACKUPD) {
-#if RTC_MEASURE_ACKUPD
-    mTimestampACKUPD = millis();
-#endif
-    RtcDueRcf_AckUpdHandler();
-//    RTC_ClearSCCR(RTC, RTC_SCCR_ACKCLR); // Already done by indirectly called RTC_SetTimeAndDate()
+    RtcDueRcf_AckUpdHandler(micros());
+//    RTC_ClearSCCR(RTC, RTC_SCCR_ACKCLR); // Already done by indirectly called RTC_CommitTimeAndDate()
   }
 
   /* RTC alarm */
@@ -318,23 +619,104 @@ bool RtcDueRcf::setTime(std::time_t utcTimestamp) {
 	Serial.print(' ');
 	Serial.println(utcTimestamp);
 #endif
-  tm time;
-  localtime_r(&utcTimestamp, &time);
-  return setTime(time);
+  RtcDueRcf_Transaction transaction;
+  return transaction.setTime(utcTimestamp) && commit(transaction);
 }
 
-bool RtcDueRcf::getLocalTime(std::tm &time) const {
-  if (mSetTimeRequest) {
-    const bool result = mSetTimeCache.isValid();
+bool RtcDueRcf::readTimeWithMicros(Sam3XA::RtcTime& rtcTime, uint32_t& microseconds) const {
+  if (not isSetTimePending()) {
+    uint32_t secondMicros;
+    const uint32_t now = micros();
+    if(mTimeSeqlock.read(rtcTime, secondMicros, now)) {
+      // The second interrupt for the next second may not yet have been
+      // serviced. Stay within this second to remain monotonic.
+      const uint32_t elapsed = now - secondMicros;
+      microseconds = elapsed < 1000000 ? elapsed : 999999;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RtcDueRcf::getTimeWithMicros(std::tm &time, uint32_t& microseconds) const {
+  Sam3XA::RtcTime rtcTime;
+  if(readTimeWithMicros(rtcTime, microseconds)) {
+    rtcTime.get(time);
+    return true;
+  }
+  return false;
+}
+
+bool RtcDueRcf::getTimeWithMicros(timespec &utcTime) const {
+  Sam3XA::RtcTime rtcTime;
+  uint32_t microseconds;
+  if(readTimeWithMicros(rtcTime, microseconds)) {
+    utcTime.tv_sec = rtcTime.toTimeStamp() + Sam3XA::RtcSnapshot::localToUtcOffset(rtcTime.rtc12hrsMode());
+    utcTime.tv_nsec = microseconds * 1000;
+    return true;
+  }
+  return false;
+}
+
+bool RtcDueRcf::readFromRtc(Sam3XA::RtcSnapshot& snapshot) const {
+  const int retries = snapshot.readFromRtc(mReadRetryLimit);
+  recordRead(retries);
+  return retries != RTC_READ_UNSTABLE;
+}
+
+void RtcDueRcf::recordRead(const int retries) const {
+  // The statistics are also recorded by the RTC interrupt.
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  mReadStatistics.record(retries);
+  __set_PRIMASK(primask);
+}
+
+RtcDueRcf_ReadStatistics RtcDueRcf::getReadStatistics() const {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  const RtcDueRcf_ReadStatistics result = mReadStatistics;
+  __set_PRIMASK(primask);
+  return result;
+}
+
+void RtcDueRcf::resetReadStatistics() {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  mReadStatistics = RtcDueRcf_ReadStatistics();
+  __set_PRIMASK(primask);
+}
+
+RtcDueRcf_SetTrace RtcDueRcf::getSetTrace() const {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  const RtcDueRcf_SetTrace result = mSetTrace;
+  __set_PRIMASK(primask);
+  return result;
+}
+
+bool RtcDueRcf::readLocalTime(Sam3XA::RtcTime& rtcTime) const {
+  if (isSetTimePending()) {
+    const Sam3XA::RtcSetTimeCache& cache = mSetTimeSlots[mSetTimeTicket & 1];
+    const bool result = cache.isValid();
     if(result) {
-      mSetTimeCache.toRtcTime().get(time);
+      rtcTime = cache.toRtcTime();
     }
     return result;
   }
 
+  // Time published by the RTC second interrupt.
+  if(mTimeSeqlock.read(rtcTime, micros())) {
+    return true;
+  }
+
   {
-    Sam3XA::RtcTime dueTimeAndDate;
-    const Sam3XA::RtcDueRcf_RtcState state(dueTimeAndDate.readFromRtc());
+    // Fall back to the RTC registers.
+    Sam3XA::RtcSnapshot snapshot;
+    if(not readFromRtc(snapshot)) {
+      return false;
+    }
+    const Sam3XA::RtcDueRcf_RtcState state(Sam3XA::RtcSnapshot::validEntryRegister());
 #if DEBUG_GET_TIME
     Serial.print("RtcDueRcf::");
     Serial.print(__FUNCTION__);
@@ -342,7 +724,189 @@ bool RtcDueRcf::getLocalTime(std::tm &time) const {
     Serial.println(state);
 #endif
     if(state.isTimeValid() && state.isCalendarValid()) {
-      dueTimeAndDate.get(time);
+      rtcTime.set(snapshot);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RtcDueRcf::getLocalTime(std::tm &time) const {
+  Sam3XA::RtcTime rtcTime;
+  if(readLocalTime(rtcTime)) {
+    rtcTime.get(time);
+    return true;
+  }
+  return false;
+}
+
+bool RtcDueRcf::getTimeOfDay(std::tm &time) const {
+  Sam3XA::RtcTime rtcTime;
+  if (isSetTimePending()) {
+    if(not readLocalTime(rtcTime)) {
+      return false;
+    }
+  } else {
+    uint32_t timeReg;
+    uint32_t rtc12HrsMode;
+    const int retries = RTC_ReadTimeReg(RTC, &timeReg, &rtc12HrsMode, mReadRetryLimit);
+    recordRead(retries);
+    if(retries == RTC_READ_UNSTABLE || (Sam3XA::RtcSnapshot::validEntryRegister() & RTC_VER_NVTIM)) {
+      return false;
+    }
+    rtcTime.setTimeOfDay(timeReg, rtc12HrsMode);
+  }
+  rtcTime.getTimeOfDay(time);
+  return true;
+}
+
+bool RtcDueRcf::getDate(std::tm &date) const {
+  Sam3XA::RtcTime rtcTime;
+  if (isSetTimePending()) {
+    if(not readLocalTime(rtcTime)) {
+      return false;
+    }
+  } else {
+    uint32_t calReg;
+    const int retries = RTC_ReadCalReg(RTC, &calReg, mReadRetryLimit);
+    recordRead(retries);
+    if(retries == RTC_READ_UNSTABLE || (Sam3XA::RtcSnapshot::validEntryRegister() & RTC_VER_NVCAL)) {
+      return false;
+    }
+    rtcTime.setDate(calReg);
+  }
+  rtcTime.getDate(date);
+  return true;
+}
+
+std::time_t RtcDueRcf::getUtcTimestamp() const {
+  Sam3XA::RtcTime rtcTime;
+  if(readLocalTime(rtcTime)) {
+    return rtcTime.toTimeStamp() + Sam3XA::RtcSnapshot::localToUtcOffset(rtcTime.rtc12hrsMode());
+  }
+  return -1;
+}
+
+bool RtcDueRcf::getTime(std::tm &localTime, std::time_t& utcTimestamp) const {
+  Sam3XA::RtcTime rtcTime;
+  if(readLocalTime(rtcTime)) {
+    rtcTime.get(localTime);
+    utcTimestamp = rtcTime.toTimeStamp() + Sam3XA::RtcSnapshot::localToUtcOffset(rtcTime.rtc12hrsMode());
+    return true;
+  }
+  return false;
+}
+
+int RtcDueRcf::registerTimeZone(const RtcDueRcf_TimeZone& timeZone) {
+  if(not timeZone.valid || mZoneCount >= RTC_MAX_TIME_ZONES) {
+    return -1;
+  }
+  mZoneViews[mZoneCount].set(timeZone);
+  return mZoneCount++;
+}
+
+int RtcDueRcf::registerTimeZone(const RtcDueRcf_TzTable& table) {
+  if(mZoneCount >= RTC_MAX_TIME_ZONES) {
+    return -1;
+  }
+  mZoneViews[mZoneCount].set(table);
+  return mZoneCount++;
+}
+
+bool RtcDueRcf::toLocalTime(const std::time_t utcTimestamp, std::tm &time, const int zoneId) const {
+  if(zoneId < 0 || static_cast<size_t>(zoneId) >= mZoneCount) {
+    return false;
+  }
+  Sam3XA::RtcTime rtcTime;
+  mZoneViews[zoneId].toLocal(utcTimestamp, rtcTime);
+  rtcTime.get(time);
+  return true;
+}
+
+bool RtcDueRcf::getLocalTime(std::tm &time, const int zoneId) const {
+  return getLocalTimes(&time, &zoneId, 1);
+}
+
+bool RtcDueRcf::getLocalTimes(std::tm times[], const int zoneIds[], const size_t count) const {
+  Sam3XA::RtcTime rtcTime;
+  if(not readLocalTime(rtcTime)) {
+    return false;
+  }
+  const std::time_t utcTimestamp = rtcTime.toTimeStamp()
+      + Sam3XA::RtcSnapshot::localToUtcOffset(rtcTime.rtc12hrsMode());
+  for(size_t i = 0; i < count; i++) {
+    if(not toLocalTime(utcTimestamp, times[i], zoneIds[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const RtcDueRcf_DriftEstimator& RtcDueRcf::getDriftEstimator() const {
+  mDriftEstimator.commit(mCommittedTicket);
+  return mDriftEstimator;
+}
+
+void RtcDueRcf::resetDriftEstimator() {
+  mDriftEstimator.commit(mCommittedTicket);
+  mDriftEstimator.reset();
+}
+
+bool RtcDueRcf::addReferenceTime(std::time_t utcTimestamp, uint32_t microseconds) {
+  mDriftEstimator.commit(mCommittedTicket);
+  timespec rtcTime;
+  if(microseconds < 1000000 && getTimeWithMicros(rtcTime)) {
+    const std::time_t seconds = rtcTime.tv_sec - utcTimestamp;
+    if(seconds > -RTC_DRIFT_MAX_OFFSET_S && seconds < RTC_DRIFT_MAX_OFFSET_S) {
+      mDriftEstimator.addSample(utcTimestamp, static_cast<int32_t>(seconds * 1000000
+          + rtcTime.tv_nsec / 1000) - static_cast<int32_t>(microseconds));
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RtcDueRcf::correctDrift() {
+  mDriftEstimator.commit(mCommittedTicket);
+  timespec rtcTime;
+  if(not mDriftEstimator.isValid() || isSetTimePending() || not getTimeWithMicros(rtcTime)
+      || rtcTime.tv_nsec / 1000 > RTC_DRIFT_LATEST_REQUEST_US) {
+    return false;
+  }
+  // Round to the minimal number of whole seconds.
+  const int32_t offset = mDriftEstimator.predictOffset(rtcTime.tv_sec);
+  const int32_t seconds = (offset + (offset < 0 ? -500000 : 500000)) / 1000000;
+  if(seconds == 0) {
+    return false;
+  }
+  // Stepping forward skips seconds, stepping backward repeats them.
+  const std::time_t stepped = rtcTime.tv_sec + 1 - seconds;
+  if(isAlarmWithin(seconds > 0 ? stepped : rtcTime.tv_sec, seconds > 0 ? rtcTime.tv_sec + 1 : stepped)) {
+    return false;
+  }
+  // The RTC commits the step upon its next second transition. The
+  // estimator takes it into account, once it has been committed.
+  if(setTime(stepped)) {
+    mDriftEstimator.requestStep(mSetTimeTicket, -seconds * 1000000);
+    return true;
+  }
+  return false;
+}
+
+bool RtcDueRcf::isAlarmWithin(const std::time_t utcBegin, const std::time_t utcEnd) {
+  RtcDueRcf_Alarm alarm;
+  getAlarm(alarm);
+  if(alarm == RtcDueRcf_Alarm()) {
+    return false;
+  }
+  for(std::time_t utc = utcBegin; utc <= utcEnd; utc++) {
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.setUtc(utc);
+    if((alarm.second == RtcDueRcf_Alarm::INVALID_VALUE || alarm.second == rtcTime.second())
+        && (alarm.minute == RtcDueRcf_Alarm::INVALID_VALUE || alarm.minute == rtcTime.minute())
+        && (alarm.hour == RtcDueRcf_Alarm::INVALID_VALUE || alarm.hour == rtcTime.hour())
+        && (alarm.day == RtcDueRcf_Alarm::INVALID_VALUE || alarm.day == rtcTime.day())
+        && (alarm.month == RtcDueRcf_Alarm::INVALID_VALUE || alarm.month == rtcTime.month())) {
       return true;
     }
   }
@@ -370,6 +934,19 @@ bool RtcDueRcf::setAlarm(const RtcDueRcf_Alarm& alarm) {
   return state.isEnabledAlarmValid();
 }
 
+bool RtcDueRcf::setAlarmRegs(const uint32_t timeAlarmReg24, const uint32_t timeAlarmReg12,
+    const uint32_t calAlarmReg) {
+  const Sam3XA::RtcDueRcf_RtcState state (
+      RTC_SetTimeAndDateAlarmRegs(RTC, timeAlarmReg24, timeAlarmReg12, calAlarmReg));
+#if DEBUG_RTC_ALARM
+  Serial.print("RtcDueRcf::");
+  Serial.print(__FUNCTION__);
+  Serial.print(' ');
+  Serial.println(state);
+#endif
+  return state.isEnabledAlarmValid();
+}
+
 bool RtcDueRcf::getAlarm(RtcDueRcf_Alarm &alarm) {
   const Sam3XA::RtcDueRcf_RtcState stateTime( RTC_GetTimeAlarm(RTC, &alarm.hour, &alarm.minute, &alarm.second));
   const Sam3XA::RtcDueRcf_RtcState stateCal( RTC_GetDateAlarm(RTC, &alarm.month, &alarm.day));
@@ -386,7 +963,21 @@ bool RtcDueRcf::getAlarm(RtcDueRcf_Alarm &alarm) {
 
 void RtcDueRcf::setSecondCallback(void (*secondCallback)(void*),
     void *secondCallbackParam) {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
   mSecondCallback = secondCallback;
   mSecondCallbackPararm = secondCallbackParam;
+  if(mEventDrivenDstCheck && secondCallback) {
+    RTC_SelectWakeup(RTC, RTC_WAKEUP_SECOND);
+  }
+  __set_PRIMASK(primask);
+}
+
+void RtcDueRcf::setCommitCallback(void (*commitCallback)(void*, uint32_t),
+    void *commitCallbackParam) {
+  RTC_DisableIt(RTC, RTC_IER_ACKEN);
+  mCommitCallback = commitCallback;
+  mCommitCallbackParam = commitCallbackParam;
+  RTC_EnableIt(RTC, RTC_IER_ACKEN);
 }
 
@@ -31,11 +31,25 @@
 #include <ctime>
 #include <include/rtc.h>
 
+#include "internal/RtcDstTransitionCache.h"
 #include "internal/RtcTime.h"
+#include "internal/RtcTimeSeqlock.h"
+#include "internal/RtcZoneView.h"
 #include "RtcDueRcf_Alarm.h"
+#include "RtcDueRcf_DriftEstimator.h"
+#include "RtcDueRcf_ReadStatistics.h"
+#include "RtcDueRcf_Regs.h"
+#include "RtcDueRcf_SetTrace.h"
+#include "RtcDueRcf_TimeZone.h"
+#include "RtcDueRcf_Transaction.h"
+#include "RtcDueRcf_TzTable.h"
 
-#ifndef RTC_MEASURE_ACKUPD
-  #define RTC_MEASURE_ACKUPD false
+/*
+ * Number of time zones, that can be registered in addition to the
+ * time zone of the RTC. See RtcDueRcf::registerTimeZone().
+ */
+#ifndef RTC_MAX_TIME_ZONES
+  #define RTC_MAX_TIME_ZONES 4
 #endif
 
 /**
@@ -116,9 +130,56 @@ public:
    * There is also no problem reading a 24-hrs format from the RTC that
    * is running in a 12-hrs mode and vice versa, because it will be converted.
    * The same is valid for writing to the RTC.
+   *
+   * The daylight savings logic and the time stamp conversion work with
+   * rules of their own, that are parsed by RtcDueRcf_TimeZone::parse().
+   * If that parser rejects the string, e.g. a quoted name like "<+03>-3"
+   * that newlib would accept, neither newlib's time zone nor the rules
+   * are changed. So both never disagree.
+   *
+   * @return true, if the time zone has been set. false, if the string
+   *  is rejected.
    */
-  static void tzset(const char* timezone) {
+  static bool tzset(const char* timezone) {
+    const RtcDueRcf_TimeZone timeZone = RtcDueRcf_TimeZone::parse(timezone);
+    if(not timeZone.valid) {
+      return false;
+    }
     setenv("TZ", timezone, true);
+    ::tzset();
+    clock.setTimeZone(timeZone);
+    return true;
+  }
+
+  /**
+   * Set time zone by passing the rules that have been parsed at compile
+   * time. There is no parsing at run time. The daylight savings logic
+   * and the time stamp conversion of this class use the rules directly.
+   *
+   * Example using predefined time zone rules (see bottom of this file.):
+   *  RtcDueRcf::clock.tzset(TZ::RULES::CET);
+   *
+   * Example using a custom time zone string:
+   *  constexpr RtcDueRcf_TimeZone CT = RtcDueRcf_TimeZone::parse("CST+6CDT+5,M3.2.0/2,M11.1.0/3");
+   *  RtcDueRcf::clock.tzset(CT);
+   *
+   * The time zone string is passed on to newlib as TZ environment
+   * variable, but it is not parsed by newlib, before mktime(),
+   * localtime() or the like are called.
+   *
+   * @param timeZone The rules. Invalid rules are ignored.
+   *
+   * @return true, if the time zone has been set. false, if the rules are
+   *  invalid.
+   */
+  static bool tzset(const RtcDueRcf_TimeZone& timeZone) {
+    if(timeZone.valid) {
+      if(timeZone.tz) {
+        setenv("TZ", timeZone.tz, true);
+      }
+      clock.setTimeZone(timeZone);
+    }
+    return timeZone.valid;
   }
 
   /**
@@ -190,6 +251,85 @@ public:
    */
   bool setTime_(const std::tm& localTime);
 
+  /**
+   * Set the RTC by a local time and date that has been converted to
+   * RTC register contents at compile time. Only the register stores
+   * remain at runtime.
+   *
+   * Usage example:
+   *  // Set local time to 27th of March 2016 01:59:50h standard time.
+   *  RtcDueRcf::clock.setTime<RtcRegs<2016, 3, 27, 1, 59, 50>>();
+   *
+   * @param RTC_REGS An RtcRegs type.
+   */
+  template<typename RTC_REGS> void setTime() {
+    setTimeRegs(RTC_REGS::timeReg, RTC_REGS::calReg, RTC_REGS::rtc12HrsMode);
+  }
+
+  /**
+   * Write the time, date, hour mode and alarm that are staged by the
+   * transaction to the RTC within the same RTC update. Like setTime(),
+   * it doesn't wait for the RTC. A later setTime(), commit() or
+   * setTimeAligned() before the RTC update supersedes the staged time.
+   * The staged alarm is carried forward to the later request, unless
+   * that one stages an alarm of its own. So an alarm, for which commit()
+   * returned true, is written to the RTC along with the latest time.
+   *
+   * Usage example:
+   *  RtcDueRcf_Transaction transaction;
+   *  transaction.setTime(time);
+   *  transaction.setAlarm(alarm);
+   *  RtcDueRcf::clock.commit(transaction);
+   *
+   * @param transaction The staged time and optionally the staged alarm.
+   *
+   * @return true if successful. false, if no time has been staged.
+   */
+  bool commit(const RtcDueRcf_Transaction& transaction);
+
+  /**
+   * Set the RTC time from an external reference, so that the RTC
+   * second transitions coincide with the second transitions of the
+   * reference. Other than setTime(), the new time is not written
+   * whenever the RTC acknowledges the update, but upon a second
+   * boundary of the reference. The RTC prescaler restarts the second
+   * at that moment. Prerequisite: time zone is set correctly.
+   *
+   * This function blocks until the time has been written, which takes
+   * up to 2 seconds. It must be called from thread level. The commit
+   * callback is called from thread level as well for this request.
+   *
+   * Usage example:
+   *  // The reference delivered 1700000000 UTC along with 250000us
+   *  // that have elapsed within that second.
+   *  RtcDueRcf::clock.setTimeAligned(1700000000, 250000);
+   *
+   * @param utcTimestamp UTC time of the reference.
+   * @param subsecondOffset Microseconds [0..999999] that have elapsed
+   *    within the second utcTimestamp at the moment of the call.
+   *
+   * @return true if successful. false, if date is lower than 1st of
+   *    January 2000, subsecondOffset is out of range or the RTC didn't
+   *    acknowledge the update within RTC_ALIGN_ACK_TIMEOUT_US. The
+   *    request is withdrawn then, along with the alarm of a pending
+   *    commit(), that has been carried forward to it. The RTC keeps its
+   *    time and the commit callback is not called.
+   */
+  bool setTimeAligned(std::time_t utcTimestamp, uint32_t subsecondOffset);
+
+  /**
+   * Get the alignment error of the latest setTimeAligned(). It is
+   * measured by micros() upon the first RTC second interrupt after the
+   * time has been written.
+   *
+   * @param[out] errorMicros The variable that will receive the time in
+   *    microseconds, by which the RTC second transition lags behind the
+   *    second transition of the reference. Negative, if it leads.
+   *
+   * @return true, if the alignment error has been measured.
+   */
+  bool getAlignmentError(int32_t& errorMicros) const;
+
   /**
    * Get the local time. Prerequisite: time zone is set correctly.
    *
@@ -199,6 +339,203 @@ public:
    */
   bool getLocalTime(std::tm &time) const;
 
+  /**
+   * Get the local time of day only. Just RTC_TIMR and RTC_MR are read
+   * from the RTC and only the time is decoded. That is cheaper than
+   * getLocalTime(), if the date is not needed.
+   *
+   * @param[out] time The variable that will receive the local time of
+   *    day. Only tm_hour, tm_min, tm_sec and tm_isdst are set.
+   *
+   * @return true, if the time is valid. Otherwise false.
+   */
+  bool getTimeOfDay(std::tm &time) const;
+
+  /**
+   * Get the local date only. Just RTC_CALR is read from the RTC and
+   * only the date is decoded.
+   *
+   * Note: getTimeOfDay() and getDate() read the RTC independently.
+   * Around midnight, the date may not belong to a time of day that has
+   * been read before. Use getLocalTime() if both are needed.
+   *
+   * @param[out] date The variable that will receive the local date.
+   *    Only tm_year, tm_mon, tm_mday, tm_wday and tm_yday are set.
+   *
+   * @return true, if the date is valid. Otherwise false.
+   */
+  bool getDate(std::tm &date) const;
+
+  /**
+   * Get the UTC time stamp. It is calculated from the local time, the
+   * daylight savings flag that is held by the RTC hour mode and the
+   * offsets of the already parsed time zone information. Other than
+   * getLocalTime() followed by std::mktime(), no newlib time zone
+   * functions are involved. Prerequisite: time zone is set correctly.
+   *
+   * @return The UTC time stamp, if the local time is valid.
+   *    Otherwise -1.
+   */
+  std::time_t getUtcTimestamp() const;
+
+  /**
+   * Get the local time and the UTC time stamp of the same second.
+   * Prerequisite: time zone is set correctly.
+   *
+   * @param[out] localTime The variable that will receive the local time.
+   * @param[out] utcTimestamp The variable that will receive the UTC time
+   *    stamp. See getUtcTimestamp().
+   *
+   * @return true, if the local time is valid. Otherwise false.
+   */
+  bool getTime(std::tm &localTime, std::time_t& utcTimestamp) const;
+
+  /**
+   * Register a time zone, that the RTC time can be converted to. The
+   * RTC keeps running with the time zone set by tzset(). Each registered
+   * zone keeps its own rules and the daylight savings period, that its
+   * last conversion has fallen into. So a conversion does not depend on
+   * the number of registered zones and does not evaluate the rules
+   * as long as the time stays within that period.
+   *
+   * Example:
+   *  const int nz = RtcDueRcf::clock.registerTimeZone(TZ::RULES::NZST);
+   *  std::tm time;
+   *  RtcDueRcf::clock.getLocalTime(time, nz);
+   *
+   * Registering zones and the conversions to them are not thread safe.
+   * Don't use them from an interrupt.
+   *
+   * @param timeZone The rules.
+   *
+   * @return The zone id [0..RTC_MAX_TIME_ZONES-1]. -1, if the rules are
+   *    invalid or RTC_MAX_TIME_ZONES zones are registered already.
+   */
+  int registerTimeZone(const RtcDueRcf_TimeZone& timeZone);
+
+  /**
+   * Same as above, but register a time zone history, that has been
+   * compiled from the tz database. See RtcDueRcf_TzTable. The table
+   * must outlive the registration.
+   *
+   * @param table The time zone history.
+   *
+   * @return The zone id [0..RTC_MAX_TIME_ZONES-1]. -1, if
+   *    RTC_MAX_TIME_ZONES zones are registered already.
+   */
+  int registerTimeZone(const RtcDueRcf_TzTable& table);
+
+  /**
+   * Get the local time of a registered time zone. The conversion
+   * takes the UTC time from the RTC like getUtcTimestamp().
+   *
+   * @param[out] time The variable that will receive the local time of
+   *    the zone. tm_isdst is set according to the rules of the zone.
+   * @param zoneId The id returned by registerTimeZone().
+   *
+   * @return true, if the RTC time is valid and zoneId is registered.
+   *    Otherwise false.
+   */
+  bool getLocalTime(std::tm &time, const int zoneId) const;
+
+  /**
+   * Get the local times of several registered time zones, that are
+   * converted from a single read of the RTC. So they all refer to the
+   * same second.
+   *
+   * @param[out] times The array that will receive the local times.
+   * @param zoneIds The ids returned by registerTimeZone().
+   * @param count The number of elements of times and zoneIds.
+   *
+   * @return true, if the RTC time is valid and all zoneIds are
+   *    registered. Otherwise false.
+   */
+  bool getLocalTimes(std::tm times[], const int zoneIds[], const size_t count) const;
+
+  /**
+   * Convert a UTC time stamp to the local time of a registered time zone.
+   *
+   * @param utcTimestamp The UTC time stamp.
+   * @param[out] time The variable that will receive the local time.
+   * @param zoneId The id returned by registerTimeZone().
+   *
+   * @return true, if zoneId is registered. Otherwise false.
+   */
+  bool toLocalTime(const std::time_t utcTimestamp, std::tm &time, const int zoneId) const;
+
+  /**
+   * Get the local time along with the microseconds that have elapsed
+   * within the current RTC second. The RTC registers are not read. The
+   * time is taken from the RTC second interrupt, that also latches
+   * micros() at the begin of each second. Successive calls deliver
+   * monotonic results.
+   *
+   * @param[out] time The variable that will receive the local time.
+   * @param[out] microseconds The variable that will receive the
+   *    microseconds [0..999999].
+   *
+   * @return true, if successful. false, before the first second
+   *    interrupt after begin() or after setting the time, or when the
+   *    second interrupt is blocked.
+   */
+  bool getTimeWithMicros(std::tm &time, uint32_t& microseconds) const;
+
+  /**
+   * Same as above, but get the UTC time with a resolution of micro
+   * seconds. Prerequisite: time zone is set correctly.
+   *
+   * @param[out] utcTime The variable that will receive the UTC time.
+   */
+  bool getTimeWithMicros(timespec &utcTime) const;
+
+  /**
+   * Feed a reference time, e.g. from NTP or GPS, to the drift
+   * estimator. The RTC time is taken by getTimeWithMicros() at the
+   * moment of the call. Prerequisite: time zone is set correctly.
+   *
+   * @param utcTimestamp UTC time of the reference.
+   * @param microseconds Microseconds [0..999999] that have elapsed
+   *    within the second utcTimestamp at the moment of the call.
+   *
+   * @return true, if the sample has been taken. false, if the RTC time
+   *    with microseconds isn't available (see getTimeWithMicros()) or
+   *    the RTC deviates by more than RTC_DRIFT_MAX_OFFSET_S seconds.
+   *    Use setTime() or setTimeAligned() then.
+   */
+  bool addReferenceTime(std::time_t utcTimestamp, uint32_t microseconds);
+
+  /**
+   * Correct the drift of the RTC, that has been learned from the
+   * reference times. When the predicted offset of the RTC reaches half
+   * a second, the RTC is stepped by the minimal number of whole seconds
+   * through setTime(). The step is postponed, if it would skip or
+   * repeat an alarm or if the next RTC second transition is close.
+   * The step is taken into account by the drift estimator, once it has
+   * been written to the RTC. If a setTime() supersedes it, the step is
+   * dropped.
+   * To be called periodically from thread level, e.g. in loop().
+   *
+   * @return true, if a step has been requested.
+   */
+  bool correctDrift();
+
+  /**
+   * Get the drift estimator. Its samples are forgotten, whenever the RTC
+   * is set by setTime(), setTime_(), setTime<>(), commit() or
+   * setTimeAligned(), because the offset of the RTC against the reference
+   * jumps then. The estimation starts over with the next reference times.
+   *
+   * @return The drift estimator, that provides the estimated drift and
+   *    the residual error.
+   */
+  const RtcDueRcf_DriftEstimator& getDriftEstimator() const;
+
+  /**
+   * Forget the reference times, that have been fed to the drift
+   * estimator.
+   */
+  void resetDriftEstimator();
+
   /**
    * Set alarm time and date.
    *
@@ -206,6 +543,24 @@ public:
    */
   bool setAlarm(const RtcDueRcf_Alarm& alarm);
 
+  /**
+   * Set alarm time and date that has been converted to RTC register
+   * contents at compile time.
+   *
+   * Usage example:
+   *  // Alarm every day at 13:**:40h
+   *  constexpr uint8_t X = RtcDueRcf_Alarm::INVALID_VALUE;
+   *  RtcDueRcf::clock.setAlarm<RtcAlarmRegs<13, X, 40, X, X>>();
+   *
+   * @param RTC_ALARM_REGS An RtcAlarmRegs type.
+   *
+   * @return true, if the set alarm is valid. Otherwise false.
+   */
+  template<typename RTC_ALARM_REGS> bool setAlarm() {
+    return setAlarmRegs(RTC_ALARM_REGS::timeAlarmReg24, RTC_ALARM_REGS::timeAlarmReg12,
+        RTC_ALARM_REGS::calAlarmReg);
+  }
+
   /**
    * Get the current RTC alarm time and date.
    *
@@ -241,22 +596,231 @@ public:
    */
   void setSecondCallback(void (*secondCallback)(void*), void *secondCallbackParam = nullptr);
 
+  /**
+   * Let the daylight savings check be event driven. The RTC second
+   * interrupt is disabled then, unless a second callback is set. The
+   * RTC time event interrupt wakes up the CPU upon every hour change,
+   * upon every minute change within the last hour before the next
+   * daylight savings transition, and the second interrupt is enabled
+   * within the last minute before it. So the RTC is switched at the
+   * same second as with the check once a second. Alarms are not
+   * touched.
+   * The time with microseconds (see getTimeWithMicros()) and thus the
+   * drift estimation require the second interrupt. getLocalTime() and
+   * the like read the RTC registers instead of the time published by
+   * the second interrupt.
+   *
+   * @param eventDriven true: Event driven check. false: Check once a
+   *    second (default).
+   */
+  void setEventDrivenDstCheck(const bool eventDriven);
+
+  /**
+   * Set the callback being called, after a time that has been passed
+   * to setTime(), setTime_() or setTime<>() has been written to the
+   * RTC. The callback is called from the RTC interrupt.
+   *
+   * @param commitCallback The function to be called upon commit. It
+   *  receives the commitCallbackParam and the latency from the set
+   *  time request to the commit in microseconds.
+   * @param commitCallbackParam This parameter will be passed
+   *  to the commitCallback function when called.
+   */
+  void setCommitCallback(void (*commitCallback)(void* commitCallbackParam, uint32_t latencyMicros),
+      void *commitCallbackParam = nullptr);
+
+  /**
+   * Get the ticket of the latest successful call of setTime(),
+   * setTime_() or setTime<>(). It can be polled by isCommitted().
+   *
+   * Usage example:
+   *  RtcDueRcf::clock.setTime(time);
+   *  const uint32_t ticket = RtcDueRcf::clock.getSetTimeTicket();
+   *  while(not RtcDueRcf::clock.isCommitted(ticket)) {...}
+   */
+  uint32_t getSetTimeTicket() const {return mSetTimeTicket;}
+
+  /**
+   * @return true, if the set time request with the ticket or a later one
+   *  has been written to the RTC or has been withdrawn by setTimeAligned().
+   */
+  bool isCommitted(const uint32_t ticket) const {
+    return static_cast<int32_t>(mCommittedTicket - ticket) >= 0;
+  }
+
+  /**
+   * @return The latency from the latest committed set time request to
+   *  its commit in microseconds.
+   */
+  uint32_t getCommitLatency() const {return mCommitLatency;}
+
+  /**
+   * @return The number of set time requests that have been replaced by
+   *  a later one, before they were written to the RTC. Back to back
+   *  requests are coalesced that way.
+   */
+  uint32_t getSupersededCount() const {return mSupersededRequests;}
+
+  /**
+   * @return The number of daylight savings adjustments that have been
+   *  replaced by a set time request before they were written to the RTC.
+   *  The daylight savings check is repeated for the time that has been
+   *  set.
+   */
+  uint32_t getSupersededDstCount() const {return mSupersededDstRequests;}
+
+  /**
+   * Get the trace of the latest commits of the set time path incl. the
+   * daylight savings adjustments. Commits of setTimeAligned() aren't
+   * traced.
+   *
+   * @return A consistent copy of the trace.
+   */
+  RtcDueRcf_SetTrace getSetTrace() const;
+
+  /**
+   * Limit the re-reads of the RTC time and date registers. When the
+   * registers do not get stable within this limit, reading the time
+   * fails rather than taking an unknown time.
+   *
+   * @param retryLimit Maximum number of re-reads. Default is
+   *    RTC_READ_RETRY_LIMIT.
+   */
+  void setReadRetryLimit(const uint8_t retryLimit) {mReadRetryLimit = retryLimit;}
+
+  /**
+   * Get the statistics of the RTC time and date register reads.
+   *
+   * @return A consistent copy of the statistics.
+   */
+  RtcDueRcf_ReadStatistics getReadStatistics() const;
+
+  /**
+   * Clear the statistics of the RTC time and date register reads.
+   */
+  void resetReadStatistics();
+
 private:
   friend void ::RTC_Handler();
 
   RtcDueRcf();
   inline void RtcDueRcf_Handler();
-  inline void RtcDueRcf_DstChecker();
-  inline void RtcDueRcf_AckUpdHandler();
+  inline void RtcDueRcf_DstChecker(const Sam3XA::RtcTime& rtcTime);
+  inline void RtcDueRcf_AckUpdHandler(const uint32_t ackMicros);
+
+  /**
+   * Select the RTC interrupt for the next daylight savings check, when
+   * the check is event driven. RTC interrupt only.
+   *
+   * @param rtcTime The time that has been read from the RTC.
+   */
+  void RtcDueRcf_SelectWakeup(const Sam3XA::RtcTime& rtcTime);
+
+  /**
+   * Set the rules for the daylight savings logic and let the RTC
+   * interrupt recalculate the next daylight savings transition.
+   */
+  void setTimeZone(const RtcDueRcf_TimeZone& timeZone);
 
-  enum SET_TIME_REQUEST {
-    NO_REQUEST = 0,
-    REQUEST,
-    DST_RTC_REQUEST
-  };
+  bool setTimeRegs(const uint32_t timeReg, const uint32_t calReg, const uint32_t rtc12HrsMode);
 
-  volatile SET_TIME_REQUEST mSetTimeRequest;
-  Sam3XA::RtcSetTimeCache mSetTimeCache;
+  /**
+   * Place the validated cache contents in the free one of the
+   * mSetTimeSlots and let the RTC interrupt request the RTC update.
+   * Lock free. To be called from thread level only.
+   */
+  void requestSetTime(const Sam3XA::RtcSetTimeCache& cache);
+
+  /**
+   * Let the committed ticket advance to the generation, but never back.
+   * The generations in between count as superseded. To be called with
+   * the RTC interrupt blocked.
+   */
+  void advanceCommittedTicket(const uint32_t generation);
+
+  /**
+   * Drop a pending daylight savings request, because a set time request
+   * has been committed. To be called with the RTC interrupt blocked.
+   */
+  void supersedeDstRequest();
+
+  /** @return true, if a set time request of the user isn't committed yet. */
+  bool isSetTimePending() const {return mSetTimeTicket != mCommittedTicket;}
+
+  /** Request the RTC update, if not yet done. RTC interrupt only. */
+  void requestRtcUpdate();
+
+  /**
+   * Get the local time from the pending set time request, the time
+   * published by the second interrupt or the RTC registers.
+   */
+  bool readLocalTime(Sam3XA::RtcTime& rtcTime) const;
+
+  bool readTimeWithMicros(Sam3XA::RtcTime& rtcTime, uint32_t& microseconds) const;
+
+  /**
+   * Bounded read of the RTC time and date registers, that is recorded
+   * in the read statistics.
+   *
+   * @return true, if the registers got stable within the retry limit.
+   */
+  bool readFromRtc(Sam3XA::RtcSnapshot& snapshot) const;
+
+  /**
+   * Record the result of a bounded register read in the read statistics.
+   */
+  void recordRead(const int retries) const;
+
+  /**
+   * @return true, if the enabled alarm matches a local time within the
+   *    UTC time stamps [utcBegin..utcEnd].
+   */
+  bool isAlarmWithin(const std::time_t utcBegin, const std::time_t utcEnd);
+
+  bool setAlarmRegs(const uint32_t timeAlarmReg24, const uint32_t timeAlarmReg12,
+      const uint32_t calAlarmReg);
+
+  // Daylight savings request. Owned by the RTC interrupt.
+  volatile bool mDstRequest;
+  Sam3XA::RtcSetTimeCache mDstCache;
+
+  // Next daylight savings transition. Owned by the RTC interrupt. It is
+  // recalculated, when mTimeZoneGeneration has been incremented by tzset().
+  Sam3XA::RtcDstTransitionCache mDstTransitionCache;
+  volatile uint32_t mTimeZoneGeneration;
+
+  // The daylight savings check is woken up by time events. See
+  // setEventDrivenDstCheck().
+  volatile bool mEventDrivenDstCheck;
+
+  // UPDTIM and UPDCAL are set, waiting for ACKUPD.
+  bool mRtcUpdateRequested;
+
+  // Set time requests of the user. The slot of generation g is g & 1.
+  Sam3XA::RtcSetTimeCache mSetTimeSlots[2];
+
+  // Aligned set time request. The RTC interrupt leaves ACKUPD to
+  // setTimeAligned(), when the generation mAlignedTicket is acknowledged.
+  volatile bool mAlignRequest;
+  volatile bool mAlignAcknowledged;
+  uint32_t mAlignedTicket;
+
+  // Intended release of the RTC by setTimeAligned() and the alignment
+  // error, that is measured upon the next second interrupt.
+  volatile bool mAlignMeasurePending;
+  volatile bool mAlignMeasured;
+  uint32_t mAlignReleaseMicros;
+  int32_t mAlignmentError;
+
+  // Local time published by the RTC second interrupt.
+  Sam3XA::RtcTimeSeqlock mTimeSeqlock;
+
+  uint8_t mReadRetryLimit;
+  mutable RtcDueRcf_ReadStatistics mReadStatistics;
+
+  // Thread level only. It catches up with the commits of the set time
+  // requests, before it is accessed.
+  mutable RtcDueRcf_DriftEstimator mDriftEstimator;
 
   void(*mSecondCallback)(void*);
   void* mSecondCallbackPararm;
@@ -264,42 +828,72 @@ private:
   void(*mAlarmCallback)(void*);
   void* mAlarmCallbackPararm;
 
-#if RTC_MEASURE_ACKUPD
-  uint32_t mTimestampACKUPD;
+  void(*mCommitCallback)(void*, uint32_t);
+  void* mCommitCallbackParam;
 
-public:
-  uint32_t getTimestampACKUPD() const {
-    return mTimestampACKUPD;
-  }
+  // Generations (tickets) of the latest set time request and the
+  // latest commit.
+  volatile uint32_t mSetTimeTicket;
+  volatile uint32_t mCommittedTicket;
+  uint32_t mSetTimeRequestMicros[2];
+  volatile uint32_t mSupersededRequests;
+  volatile uint32_t mSupersededDstRequests;
+  volatile uint32_t mCommitLatency;
 
-#endif
+  // Time of the daylight savings request.
+  uint32_t mDstRequestMicros;
+
+  // Written by the RTC interrupt only.
+  RtcDueRcf_SetTrace mSetTrace;
+
+  // Registered time zones. Thread level only.
+  mutable Sam3XA::RtcZoneView mZoneViews[RTC_MAX_TIME_ZONES];
+  size_t mZoneCount;
 };
 
 namespace TZ {
   /**
    * Some predefined time zone strings for convenience.
    */
-  const char* const UTC = "UTC+0:00:00"; // (Coordinated Universal Time)
+  constexpr const char* UTC = "UTC+0:00:00"; // (Coordinated Universal Time)
 
   // Daylight savings starts at the last Sunday of march 2:00h and ends at the last Sunday of October 3:00h
   // EUROPE
-  const char* const UK  = "UK+0:00:00UKDST-1:00:00,M3.5.0/2,M10.5.0/3";   // (United Kingdom)
-  const char* const CET = "CET-1:00:00CETDST-2:00:00,M3.5.0/2,M10.5.0/3"; // (Central Europe)
+  constexpr const char* UK  = "UK+0:00:00UKDST-1:00:00,M3.5.0/2,M10.5.0/3";   // (United Kingdom)
+  constexpr const char* CET = "CET-1:00:00CETDST-2:00:00,M3.5.0/2,M10.5.0/3"; // (Central Europe)
 
   // Daylight savings starts at the second Sunday of march 2:00h and ends at the first Sunday of November 3:00h
   // USA
-  const char* const EST = "EST+5:00:00";                                // (Eastern Standard Time)
-  const char* const ET  = "ET+5:00:00ETDST+4:00:00,M3.2.0/2,M11.1.0/3"; // (Eastern Time)
-  const char* const CST = "CST+6:00:00";                                // (Central Standard Time)
-  const char* const CT  = "CT+6:00:00+5:00:00,M3.2.0/2,M11.1.0/3";      // (Central Time)
-  const char* const MST = "MST+7:00:00";                                // (Mountain Standard Time)
-  const char* const MT  = "MST+7:00:00+6:00:00,M3.2.0/2,M11.1.0/3";     // (Mountain Time)
-  const char* const PST = "PST+8:00:00";                                // (Pacific Standard Time)
-  const char* const PT  = "PST+8:00:00+7:00:00,M3.2.0/2,M11.1.0/3";     // (Pacific Time)
+  constexpr const char* EST = "EST+5:00:00";                                // (Eastern Standard Time)
+  constexpr const char* ET  = "ET+5:00:00ETDST+4:00:00,M3.2.0/2,M11.1.0/3"; // (Eastern Time)
+  constexpr const char* CST = "CST+6:00:00";                                // (Central Standard Time)
+  constexpr const char* CT  = "CT+6:00:00+5:00:00,M3.2.0/2,M11.1.0/3";      // (Central Time)
+  constexpr const char* MST = "MST+7:00:00";                                // (Mountain Standard Time)
+  constexpr const char* MT  = "MST+7:00:00+6:00:00,M3.2.0/2,M11.1.0/3";     // (Mountain Time)
+  constexpr const char* PST = "PST+8:00:00";                                // (Pacific Standard Time)
+  constexpr const char* PT  = "PST+8:00:00+7:00:00,M3.2.0/2,M11.1.0/3";     // (Pacific Time)
 
   // Daylight savings starts at the last Sunday of September 2:00h (default time) and ends at first Sunday of April 3:00h.
   // NEW ZEALAND
-  const char* const NZST= "NZST-12:00:00NZDT-13:00:00,M9.5.0,M4.1.0/3"; // (New Zealand)
+  constexpr const char* NZST= "NZST-12:00:00NZDT-13:00:00,M9.5.0,M4.1.0/3"; // (New Zealand)
+
+  /**
+   * The predefined time zones, parsed at compile time.
+   */
+  namespace RULES {
+    constexpr RtcDueRcf_TimeZone UTC  = RtcDueRcf_TimeZone::parse(TZ::UTC);
+    constexpr RtcDueRcf_TimeZone UK   = RtcDueRcf_TimeZone::parse(TZ::UK);
+    constexpr RtcDueRcf_TimeZone CET  = RtcDueRcf_TimeZone::parse(TZ::CET);
+    constexpr RtcDueRcf_TimeZone EST  = RtcDueRcf_TimeZone::parse(TZ::EST);
+    constexpr RtcDueRcf_TimeZone ET   = RtcDueRcf_TimeZone::parse(TZ::ET);
+    constexpr RtcDueRcf_TimeZone CST  = RtcDueRcf_TimeZone::parse(TZ::CST);
+    constexpr RtcDueRcf_TimeZone CT   = RtcDueRcf_TimeZone::parse(TZ::CT);
+    constexpr RtcDueRcf_TimeZone MST  = RtcDueRcf_TimeZone::parse(TZ::MST);
+    constexpr RtcDueRcf_TimeZone MT   = RtcDueRcf_TimeZone::parse(TZ::MT);
+    constexpr RtcDueRcf_TimeZone PST  = RtcDueRcf_TimeZone::parse(TZ::PST);
+    constexpr RtcDueRcf_TimeZone PT   = RtcDueRcf_TimeZone::parse(TZ::PT);
+    constexpr RtcDueRcf_TimeZone NZST = RtcDueRcf_TimeZone::parse(TZ::NZST);
+  }
 }
 
 #endif /* RTCDUERCF_SRC_RTCDUERCF_H_ */
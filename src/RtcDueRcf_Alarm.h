@@ -61,6 +61,7 @@
  */
 class RtcDueRcf_Alarm : public Printable {
   friend class RtcDueRcf;
+  friend class RtcDueRcf_Transaction;
 public:
   RtcDueRcf_Alarm();
   RtcDueRcf_Alarm(int tm_sec, int tm_min, int tm_hour, int tm_mday, int tm_mon /* 0..11 */);
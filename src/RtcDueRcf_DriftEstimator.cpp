@@ -0,0 +1,121 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <math.h>
+#include "RtcDueRcf_DriftEstimator.h"
+
+RtcDueRcf_DriftEstimator::RtcDueRcf_DriftEstimator()
+  : mStepTicket(0)
+  , mStepMicros(0)
+  , mCommittedTicket(0) {
+  reset();
+}
+
+void RtcDueRcf_DriftEstimator::reset() {
+  mCount = 0;
+  mNext = 0;
+  mSteps = 0;
+  mOrigin = 0;
+  mIntercept = 0;
+  mSlope = 0;
+  mResidual = 0;
+}
+
+void RtcDueRcf_DriftEstimator::addSample(std::time_t referenceTime, int32_t offsetMicros) {
+  mTimes[mNext] = referenceTime;
+  mOffsets[mNext] = offsetMicros - mSteps;
+  mNext = (mNext + 1) % WINDOW_SIZE;
+  if(mCount < WINDOW_SIZE) {
+    mCount++;
+  }
+  estimate();
+}
+
+void RtcDueRcf_DriftEstimator::addStep(int32_t stepMicros) {
+  mSteps += stepMicros;
+}
+
+void RtcDueRcf_DriftEstimator::requestStep(uint32_t ticket, int32_t stepMicros) {
+  mStepTicket = ticket;
+  mStepMicros = stepMicros;
+}
+
+void RtcDueRcf_DriftEstimator::commit(uint32_t committedTicket) {
+  if(committedTicket != mCommittedTicket) {
+    if(committedTicket == mStepTicket && committedTicket - mCommittedTicket == 1) {
+      addStep(mStepMicros);
+    } else {
+      reset();
+    }
+    mCommittedTicket = committedTicket;
+  }
+}
+
+bool RtcDueRcf_DriftEstimator::isValid() const {
+  if(mCount < 2) {
+    return false;
+  }
+  const size_t oldest = mCount < WINDOW_SIZE ? 0 : mNext;
+  return mOrigin - mTimes[oldest] >= static_cast<std::time_t>(MIN_SPAN_SECONDS);
+}
+
+int32_t RtcDueRcf_DriftEstimator::predictOffset(std::time_t time) const {
+  const double dt = static_cast<double>(time - mOrigin);
+  return static_cast<int32_t>(lround(mIntercept + mSlope * dt)) + mSteps;
+}
+
+/**
+ * Least squares regression of the offsets over the times. The times are
+ * taken relative to the latest sample, to keep the precision of a double.
+ * An offset in microseconds over a time in seconds gives ppm directly.
+ */
+void RtcDueRcf_DriftEstimator::estimate() {
+  mOrigin = mTimes[(mNext + WINDOW_SIZE - 1) % WINDOW_SIZE];
+
+  double sumT = 0;
+  double sumY = 0;
+  for(size_t i = 0; i < mCount; i++) {
+    sumT += static_cast<double>(mTimes[i] - mOrigin);
+    sumY += mOffsets[i];
+  }
+  const double meanT = sumT / mCount;
+  const double meanY = sumY / mCount;
+
+  double sumTT = 0;
+  double sumTY = 0;
+  for(size_t i = 0; i < mCount; i++) {
+    const double t = static_cast<double>(mTimes[i] - mOrigin) - meanT;
+    sumTT += t * t;
+    sumTY += t * (mOffsets[i] - meanY);
+  }
+  mSlope = sumTT > 0 ? sumTY / sumTT : 0;
+  mIntercept = meanY - mSlope * meanT;
+
+  double sumRR = 0;
+  for(size_t i = 0; i < mCount; i++) {
+    const double r = mOffsets[i] - (mIntercept + mSlope * static_cast<double>(mTimes[i] - mOrigin));
+    sumRR += r * r;
+  }
+  mResidual = sqrt(sumRR / mCount);
+}
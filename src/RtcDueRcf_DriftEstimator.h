@@ -0,0 +1,162 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_RTCDUERCF_DRIFTESTIMATOR_H_
+#define RTCDUERCF_SRC_RTCDUERCF_DRIFTESTIMATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ctime>
+
+/**
+ * The class RtcDueRcf_DriftEstimator learns the frequency error of the
+ * RTC crystal from reference times. The SAM3X RTC has no calibration
+ * register, so the error can only be compensated by stepping the RTC.
+ *
+ * Each sample is the offset of the RTC time against a reference time.
+ * The drift is the slope of a least squares regression line through the
+ * latest WINDOW_SIZE samples. Steps that have been applied to the RTC
+ * are taken out of the samples, so they don't disturb the regression.
+ * Any other setting of the RTC invalidates the samples.
+ *
+ * The class has no dependencies to the Arduino core. It can be tested
+ * on the host, see extras/host/RtcDueRcf_DriftEstimator_test.cpp.
+ *
+ * Usage example:
+ *  RtcDueRcf::clock.addReferenceTime(ntpSeconds, ntpMicros);
+ *  RtcDueRcf::clock.correctDrift();
+ *  const RtcDueRcf_DriftEstimator& estimator = RtcDueRcf::clock.getDriftEstimator();
+ *  if(estimator.isValid()) {
+ *    Serial.println(estimator.driftPpm());
+ *  }
+ */
+class RtcDueRcf_DriftEstimator {
+public:
+  /** Number of samples that the regression is calculated of. */
+  static constexpr size_t WINDOW_SIZE = 16;
+
+  /** Minimum time span in seconds of the samples for a valid estimation. */
+  static constexpr uint32_t MIN_SPAN_SECONDS = 600;
+
+  RtcDueRcf_DriftEstimator();
+
+  /**
+   * Add a sample.
+   *
+   * @param referenceTime The reference time in seconds, e.g. UTC. Must
+   *    not decrease from sample to sample.
+   * @param offsetMicros The RTC time minus the reference time in
+   *    microseconds at that moment.
+   */
+  void addSample(std::time_t referenceTime, int32_t offsetMicros);
+
+  /**
+   * Take into account, that the RTC has been stepped.
+   *
+   * @param stepMicros The time in microseconds that has been added to
+   *    the RTC time.
+   */
+  void addStep(int32_t stepMicros);
+
+  /** Forget all samples and steps. */
+  void reset();
+
+  /**
+   * Announce a step, that has been requested as set time generation
+   * (ticket). It is taken into account by commit(), once exactly that
+   * generation has been written to the RTC.
+   *
+   * @param ticket The generation of the set time request.
+   * @param stepMicros The time in microseconds that is added to the RTC
+   *    time.
+   */
+  void requestStep(uint32_t ticket, int32_t stepMicros);
+
+  /**
+   * Take into account the set time generations, that have been written
+   * to the RTC up to the committed ticket. If that is just the generation
+   * of the requested step, the step is added. Otherwise the RTC has been
+   * set from outside, e.g. by a resync to the reference, or the step has
+   * been superseded. All samples and steps are forgotten then.
+   *
+   * @param committedTicket The latest generation, that has been written
+   *    to the RTC.
+   */
+  void commit(uint32_t committedTicket);
+
+  /**
+   * @return true, if there are at least 2 samples spanning at least
+   *    MIN_SPAN_SECONDS.
+   */
+  bool isValid() const;
+
+  /** @return Number of samples within the window. */
+  size_t samples() const {return mCount;}
+
+  /**
+   * @return The estimated drift in parts per million. Positive, if
+   *    the RTC runs fast.
+   */
+  double driftPpm() const {return mSlope;}
+
+  /**
+   * @return The root mean square of the sample offsets against the
+   *    regression line in microseconds.
+   */
+  double residualMicros() const {return mResidual;}
+
+  /**
+   * @return The predicted offset of the RTC time against the reference
+   *    time in microseconds at the time, incl. the applied steps.
+   */
+  int32_t predictOffset(std::time_t time) const;
+
+private:
+  void estimate();
+
+  // The samples with the steps taken out.
+  std::time_t mTimes[WINDOW_SIZE];
+  int32_t mOffsets[WINDOW_SIZE];
+  size_t mCount;
+  size_t mNext;
+
+  // Sum of all applied steps.
+  int32_t mSteps;
+
+  // Generation of the requested step and the latest generation, that
+  // has been taken into account.
+  uint32_t mStepTicket;
+  int32_t mStepMicros;
+  uint32_t mCommittedTicket;
+
+  // Regression line at mOrigin, the time of the latest sample.
+  std::time_t mOrigin;
+  double mIntercept;
+  double mSlope;
+  double mResidual;
+};
+
+#endif /* RTCDUERCF_SRC_RTCDUERCF_DRIFTESTIMATOR_H_ */
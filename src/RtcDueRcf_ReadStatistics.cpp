@@ -0,0 +1,61 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <print.h>
+#include "internal/core-sam-GapClose.h"
+#include "RtcDueRcf_ReadStatistics.h"
+
+size_t RtcDueRcf_ReadStatistics::printTo(Print& p) const {
+  size_t result = 0;
+  result += p.print("reads:"); result += p.print(mReads);
+  result += p.print(" failed:"); result += p.print(mFailures);
+  result += p.print(" retries");
+  for(size_t i = 0; i < HISTOGRAM_SIZE; i++) {
+    result += p.print(' ');
+    result += p.print(static_cast<unsigned>(i));
+    if(i == HISTOGRAM_SIZE - 1) {
+      result += p.print('+');
+    }
+    result += p.print(':');
+    result += p.print(mHistogram[i]);
+  }
+  result += p.print(" max:"); result += p.print(mMaxRetries);
+  return result;
+}
+
+RtcDueRcf_ReadStatistics::RtcDueRcf_ReadStatistics()
+  : mReads(0), mFailures(0), mHistogram{0}, mMaxRetries(0) {
+}
+
+void RtcDueRcf_ReadStatistics::record(const int retries) {
+  mReads++;
+  if(retries == RTC_READ_UNSTABLE) {
+    mFailures++;
+    return;
+  }
+  mHistogram[static_cast<size_t>(retries) < HISTOGRAM_SIZE ? retries : HISTOGRAM_SIZE - 1]++;
+  if(retries > mMaxRetries) {
+    mMaxRetries = retries;
+  }
+}
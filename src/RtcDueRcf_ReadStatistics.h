@@ -0,0 +1,82 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_RTCDUERCF_READSTATISTICS_H_
+#define RTCDUERCF_SRC_RTCDUERCF_READSTATISTICS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Printable.h>
+
+/**
+ * The class RtcDueRcf_ReadStatistics counts how often the RTC time
+ * and date registers had to be re-read, until they were stable. That
+ * allows to characterize the latency of reading the RTC.
+ *
+ * Print example:
+ *  Serial.println(RtcDueRcf::clock.getReadStatistics());
+ */
+class RtcDueRcf_ReadStatistics : public Printable {
+  friend class RtcDueRcf;
+public:
+  /**
+   * Number of histogram buckets. The last bucket counts all reads
+   * with HISTOGRAM_SIZE-1 or more re-reads.
+   */
+  static constexpr size_t HISTOGRAM_SIZE = 4;
+
+  RtcDueRcf_ReadStatistics();
+
+  /** @return Number of reads incl. the failed ones. */
+  uint32_t reads() const {return mReads;}
+
+  /** @return Number of reads that did not get stable within the retry limit. */
+  uint32_t failures() const {return mFailures;}
+
+  /** @return Maximum number of re-reads of a successful read. */
+  uint8_t maxRetries() const {return mMaxRetries;}
+
+  /** @return Number of successful reads that needed retries re-reads. */
+  uint32_t histogram(const size_t retries) const {
+    return mHistogram[retries < HISTOGRAM_SIZE ? retries : HISTOGRAM_SIZE - 1];
+  }
+
+  size_t printTo(Print& p) const override;
+
+private:
+  /**
+   * @param retries The result of RTC_ReadTimeSnapshot(). Either the
+   *    number of re-reads or RTC_READ_UNSTABLE.
+   */
+  void record(const int retries);
+
+  uint32_t mReads;
+  uint32_t mFailures;
+  uint32_t mHistogram[HISTOGRAM_SIZE];
+  uint8_t mMaxRetries;
+};
+
+#endif /* RTCDUERCF_SRC_RTCDUERCF_READSTATISTICS_H_ */
@@ -0,0 +1,192 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_RTCDUERCF_REGS_H_
+#define RTCDUERCF_SRC_RTCDUERCF_REGS_H_
+
+#include <stdint.h>
+
+namespace Sam3XA {
+namespace RtcRegsConstexpr {
+
+constexpr uint32_t bcd(const uint32_t value) {
+  return ((value / 10) << 4) | (value % 10);
+}
+
+constexpr bool isLeapYear(const uint32_t year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+constexpr uint32_t daysInMonth(const uint32_t year, const uint32_t month) {
+  return month == 2 ? (isLeapYear(year) ? 29 : 28)
+      : (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+}
+
+/* For a description of the days_from_civil algorithm see
+ * http://howardhinnant.github.io/date_algorithms.html#days_from_civil */
+constexpr uint32_t dayOfYearFromMarch(const uint32_t month, const uint32_t day) {
+  return (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+}
+
+constexpr uint32_t dayOfEra(const uint32_t yearOfEra, const uint32_t month, const uint32_t day) {
+  return yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYearFromMarch(month, day);
+}
+
+constexpr int32_t daysFromCivil_(const uint32_t year /* march based */, const uint32_t month, const uint32_t day) {
+  return static_cast<int32_t>((year / 400) * 146097 + dayOfEra(year % 400, month, day)) - 719468;
+}
+
+/** Days since 1st of January 1970. */
+constexpr int32_t daysFromCivil(const uint32_t year, const uint32_t month, const uint32_t day) {
+  return daysFromCivil_(month <= 2 ? year - 1 : year, month, day);
+}
+
+/** Day of week as used by the RTC: 1=SUN ..7=SAT. 1st of January 1970 is Thursday. */
+constexpr uint32_t rtcDayOfWeek(const uint32_t year, const uint32_t month, const uint32_t day) {
+  return (daysFromCivil(year, month, day) % 7 + 11) % 7 + 1; // also for dates before 1970
+}
+
+/** Hour field of RTC_TIMR / RTC_TIMALR incl. the AMPM bit. hour is [0..23]. */
+constexpr uint32_t hourField(const uint32_t hour, const bool rtc12HrsMode) {
+  return not rtc12HrsMode ? bcd(hour)
+      : hour == 0  ? bcd(12)
+      : hour < 12  ? bcd(hour)
+      : hour == 12 ? (1u << 6) | bcd(12)
+      : (1u << 6) | bcd(hour - 12);
+}
+
+constexpr uint32_t timeReg(const uint32_t hour, const uint32_t minute, const uint32_t second,
+    const bool rtc12HrsMode) {
+  return (hourField(hour, rtc12HrsMode) << 16) | (bcd(minute) << 8) | bcd(second);
+}
+
+constexpr uint32_t calReg(const uint32_t year, const uint32_t month, const uint32_t day) {
+  return bcd(year / 100) | (bcd(year % 100) << 8) | (bcd(month) << 16)
+      | (rtcDayOfWeek(year, month, day) << 21) | (bcd(day) << 24);
+}
+
+constexpr uint32_t ALARM_DISABLED = UINT8_MAX;
+
+constexpr uint32_t timeAlarmReg(const uint32_t hour, const uint32_t minute, const uint32_t second,
+    const bool rtc12HrsMode) {
+  return timeReg(hour != ALARM_DISABLED ? hour : 12, minute != ALARM_DISABLED ? minute : 0,
+        second != ALARM_DISABLED ? second : 0, rtc12HrsMode)
+      | (hour   != ALARM_DISABLED ? (1u << 23) : 0) /* HOUREN */
+      | (minute != ALARM_DISABLED ? (1u << 15) : 0) /* MINEN  */
+      | (second != ALARM_DISABLED ? (1u <<  7) : 0) /* SECEN  */;
+}
+
+constexpr uint32_t calAlarmReg(const uint32_t month, const uint32_t day) {
+  return (bcd(month != ALARM_DISABLED ? month : 1) << 16) | (bcd(day != ALARM_DISABLED ? day : 1) << 24)
+      | (month != ALARM_DISABLED ? (1u << 23) : 0) /* MTHEN  */
+      | (day   != ALARM_DISABLED ? (1u << 31) : 0) /* DATEEN */;
+}
+
+} // namespace RtcRegsConstexpr
+} // namespace Sam3XA
+
+/**
+ * RtcRegs calculates the contents of the RTC_TIMR and RTC_CALR registers
+ * for a fixed local time and date at compile time. Invalid time or date
+ * values are rejected by the compiler.
+ *
+ * Usage example:
+ *
+ * // Preset 27th of March 2016 01:59:50h standard time.
+ * RtcDueRcf::clock.setTime<RtcRegs<2016, 3, 27, 1, 59, 50>>();
+ *
+ * @param YEAR   Anno domini year [2000..2099].
+ * @param MONTH  Month [1..12].
+ * @param DAY    Day within month [1..31].
+ * @param HOUR   Hour in 24-hrs representation [0..23].
+ * @param MINUTE Minute [0..59].
+ * @param SECOND Second [0..59].
+ * @param ISDST  true, if the time is a daylight savings time. Like for
+ *    RtcDueRcf::setTime_(), it is not checked whether this fits to the
+ *    time zone information.
+ */
+template<uint16_t YEAR, uint8_t MONTH, uint8_t DAY, uint8_t HOUR, uint8_t MINUTE, uint8_t SECOND,
+    bool ISDST = false>
+struct RtcRegs {
+  static_assert(YEAR >= 2000 && YEAR <= 2099, "RtcRegs: YEAR must be within [2000..2099].");
+  static_assert(MONTH >= 1 && MONTH <= 12, "RtcRegs: MONTH must be within [1..12].");
+  static_assert(DAY >= 1 && DAY <= Sam3XA::RtcRegsConstexpr::daysInMonth(YEAR, MONTH),
+      "RtcRegs: DAY does not exist within MONTH.");
+  static_assert(HOUR < 24, "RtcRegs: HOUR must be within [0..23].");
+  static_assert(MINUTE < 60, "RtcRegs: MINUTE must be within [0..59].");
+  static_assert(SECOND < 60, "RtcRegs: SECOND must be within [0..59].");
+
+  //  0: RTC runs in 24-hrs mode.
+  //  1: RTC runs in 12-hrs mode.
+  static constexpr uint32_t rtc12HrsMode = ISDST ? 1 : 0;
+
+  /** Contents of the RTC_TIMR register. */
+  static constexpr uint32_t timeReg = Sam3XA::RtcRegsConstexpr::timeReg(HOUR, MINUTE, SECOND, ISDST);
+
+  /** Contents of the RTC_CALR register. */
+  static constexpr uint32_t calReg = Sam3XA::RtcRegsConstexpr::calReg(YEAR, MONTH, DAY);
+};
+
+/**
+ * RtcAlarmRegs calculates the contents of the RTC_TIMALR and RTC_CALALR
+ * registers for a fixed alarm at compile time. Pass
+ * RtcDueRcf_Alarm::INVALID_VALUE for the fields that shall not be
+ * considered for the alarm.
+ *
+ * Usage example:
+ *
+ * // Alarm every day at 13:**:40h
+ * constexpr uint8_t X = RtcDueRcf_Alarm::INVALID_VALUE;
+ * RtcDueRcf::clock.setAlarm<RtcAlarmRegs<13, X, 40, X, X>>();
+ *
+ * @param HOUR   Hour in 24-hrs representation [0..23].
+ * @param MINUTE Minute [0..59].
+ * @param SECOND Second [0..59].
+ * @param MONTH  Month [1..12].
+ * @param DAY    Day within month [1..31].
+ */
+template<uint8_t HOUR, uint8_t MINUTE, uint8_t SECOND, uint8_t MONTH, uint8_t DAY>
+struct RtcAlarmRegs {
+  static_assert(HOUR < 24 || HOUR == UINT8_MAX, "RtcAlarmRegs: HOUR must be within [0..23].");
+  static_assert(MINUTE < 60 || MINUTE == UINT8_MAX, "RtcAlarmRegs: MINUTE must be within [0..59].");
+  static_assert(SECOND < 60 || SECOND == UINT8_MAX, "RtcAlarmRegs: SECOND must be within [0..59].");
+  static_assert((MONTH >= 1 && MONTH <= 12) || MONTH == UINT8_MAX, "RtcAlarmRegs: MONTH must be within [1..12].");
+  static_assert((DAY >= 1 && DAY <= 31) || DAY == UINT8_MAX, "RtcAlarmRegs: DAY must be within [1..31].");
+  static_assert(MONTH == UINT8_MAX || DAY == UINT8_MAX
+      || DAY <= Sam3XA::RtcRegsConstexpr::daysInMonth(2000 /* leap year */, MONTH),
+      "RtcAlarmRegs: DAY does not exist within MONTH.");
+
+  /** Contents of the RTC_TIMALR register, when the RTC runs in 24-hrs mode. */
+  static constexpr uint32_t timeAlarmReg24 = Sam3XA::RtcRegsConstexpr::timeAlarmReg(HOUR, MINUTE, SECOND, false);
+
+  /** Contents of the RTC_TIMALR register, when the RTC runs in 12-hrs mode. */
+  static constexpr uint32_t timeAlarmReg12 = Sam3XA::RtcRegsConstexpr::timeAlarmReg(HOUR, MINUTE, SECOND, true);
+
+  /** Contents of the RTC_CALALR register. */
+  static constexpr uint32_t calAlarmReg = Sam3XA::RtcRegsConstexpr::calAlarmReg(MONTH, DAY);
+};
+
+#endif /* RTCDUERCF_SRC_RTCDUERCF_REGS_H_ */
@@ -0,0 +1,80 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <print.h>
+#include "RtcDueRcf_SetTrace.h"
+
+RtcDueRcf_SetTrace::RtcDueRcf_SetTrace()
+  : mRecords{}, mCount(0) {
+}
+
+void RtcDueRcf_SetTrace::record(const SOURCE source, const uint32_t requestMicros,
+    const uint32_t ackMicros, const uint32_t commitMicros) {
+  Record& record = mRecords[mCount % SIZE];
+  record.requestMicros = requestMicros;
+  record.ackMicros = ackMicros;
+  record.commitMicros = commitMicros < UINT16_MAX ? commitMicros : UINT16_MAX;
+  record.source = source;
+  mCount++;
+}
+
+uint32_t RtcDueRcf_SetTrace::value(const METRIC metric, const size_t i) const {
+  return metric == ACK_LATENCY ? (*this)[i].ackLatency() : (*this)[i].commitMicros;
+}
+
+uint32_t RtcDueRcf_SetTrace::percentile(const METRIC metric, const unsigned percent) const {
+  const size_t n = size();
+  if(n == 0) {
+    return 0;
+  }
+  // Insertion sort, there are only a few records.
+  uint32_t values[SIZE];
+  for(size_t i = 0; i < n; i++) {
+    const uint32_t v = value(metric, i);
+    size_t j = i;
+    for(; j > 0 && values[j-1] > v; j--) {
+      values[j] = values[j-1];
+    }
+    values[j] = v;
+  }
+  const size_t rank = ((percent < 100 ? percent : 100) * n + 99) / 100;
+  return values[rank > 0 ? rank - 1 : 0];
+}
+
+size_t RtcDueRcf_SetTrace::printTo(Print& p) const {
+  static const char* const METRIC_NAMES[] = {"ack latency", "commit"};
+  size_t result = 0;
+  result += p.print("commits:"); result += p.print(mCount);
+  for(size_t m = 0; m < sizeof(METRIC_NAMES)/sizeof(METRIC_NAMES[0]); m++) {
+    const METRIC metric = static_cast<METRIC>(m);
+    result += p.print(' ');
+    result += p.print(METRIC_NAMES[m]);
+    result += p.print(" min:"); result += p.print(minimum(metric));
+    result += p.print(" p50:"); result += p.print(percentile(metric, 50));
+    result += p.print(" p90:"); result += p.print(percentile(metric, 90));
+    result += p.print(" max:"); result += p.print(maximum(metric));
+    result += p.print("us");
+  }
+  return result;
+}
@@ -0,0 +1,114 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_RTCDUERCF_SETTRACE_H_
+#define RTCDUERCF_SRC_RTCDUERCF_SETTRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Printable.h>
+
+/*
+ * Number of set time commits that are kept in the trace.
+ */
+#ifndef RTC_SET_TRACE_SIZE
+  #define RTC_SET_TRACE_SIZE 16
+#endif
+
+/**
+ * The class RtcDueRcf_SetTrace is a ring buffer of the latest commits
+ * of the set time path. It is recorded by the RTC interrupt with a few
+ * stores per commit, so it is always available without perturbing the
+ * timing.
+ *
+ * Print example:
+ *  Serial.println(RtcDueRcf::clock.getSetTrace());
+ */
+class RtcDueRcf_SetTrace : public Printable {
+  friend class RtcDueRcf;
+public:
+  static constexpr size_t SIZE = RTC_SET_TRACE_SIZE;
+
+  enum SOURCE : uint8_t {
+    REQUEST,         // setTime(), setTime_(), setTime<>() or commit()
+    DST_RTC_REQUEST, // daylight savings adjustment
+  };
+
+  struct Record {
+    uint32_t requestMicros; // micros() upon the request
+    uint32_t ackMicros;     // micros() upon the ACKUPD interrupt
+    uint16_t commitMicros;  // Duration of writing the RTC registers
+    SOURCE source;
+
+    uint32_t ackLatency() const {return ackMicros - requestMicros;}
+  };
+
+  enum METRIC : uint8_t {
+    ACK_LATENCY,     // From the request to the ACKUPD interrupt
+    COMMIT_DURATION, // Writing the RTC registers
+  };
+
+  RtcDueRcf_SetTrace();
+
+  /** @return Number of records held [0..SIZE]. */
+  size_t size() const {return mCount < SIZE ? mCount : SIZE;}
+
+  /** @return Number of commits since begin, incl. the overwritten records. */
+  uint32_t count() const {return mCount;}
+
+  /** @param i [0..size()-1] 0 is the oldest record. */
+  const Record& operator[](const size_t i) const {
+    return mRecords[(mCount < SIZE ? i : mCount + i) % SIZE];
+  }
+
+  /** @return The minimum of the metric in microseconds. 0, if empty. */
+  uint32_t minimum(const METRIC metric) const {return percentile(metric, 0);}
+
+  /** @return The maximum of the metric in microseconds. 0, if empty. */
+  uint32_t maximum(const METRIC metric) const {return percentile(metric, 100);}
+
+  /**
+   * @param percent [0..100]
+   *
+   * @return The nearest rank percentile of the metric in microseconds.
+   *    0, if empty.
+   */
+  uint32_t percentile(const METRIC metric, const unsigned percent) const;
+
+  size_t printTo(Print& p) const override;
+
+private:
+  /** To be called from the RTC interrupt. */
+  void record(const SOURCE source, const uint32_t requestMicros, const uint32_t ackMicros,
+      const uint32_t commitMicros);
+
+  uint32_t value(const METRIC metric, const size_t i) const;
+
+  Record mRecords[SIZE];
+  uint32_t mCount;
+};
+
+#endif /* RTCDUERCF_SRC_RTCDUERCF_SETTRACE_H_ */
@@ -0,0 +1,230 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_RTCDUERCF_TIMEZONE_H_
+#define RTCDUERCF_SRC_RTCDUERCF_TIMEZONE_H_
+
+#include <stdint.h>
+
+/**
+ * A daylight savings transition rule as parsed from a POSIX time zone
+ * string. The fields correspond to the ones of newlib's __tzrule_struct.
+ */
+struct RtcDueRcf_TzRule {
+  char ch;        // 'M': Month, week and day of week. 'J', 'D': Day of year.
+  uint8_t m;      // Month [1..12]
+  uint8_t n;      // Week within the month [1..5]. 5 means the last week.
+  uint16_t d;     // Day of week [0..6] 0=SUN for 'M', day of year otherwise.
+  int32_t s;      // Seconds after midnight, when the transition happens.
+  int32_t offset; // Seconds west of UTC, that apply after the transition.
+};
+
+/**
+ * The rules of a time zone, parsed from a POSIX time zone string. The
+ * parser is constexpr, so a time zone string literal is turned into
+ * rules at compile time and RtcDueRcf::tzset() does not need newlib
+ * to parse it.
+ *
+ * Usage example:
+ *
+ *  // Zone of Central Europe, parsed at compile time.
+ *  RtcDueRcf::tzset(TZ::RULES::CET);
+ *
+ *  // Custom zone, parsed at compile time.
+ *  constexpr RtcDueRcf_TimeZone AEST =
+ *      RtcDueRcf_TimeZone::parse("AEST-10AEDT,M10.1.0,M4.1.0/3");
+ *  static_assert(AEST.valid, "Invalid time zone string");
+ *  RtcDueRcf::tzset(AEST);
+ *
+ * The string is parsed the same way newlib does it. Note: The daylight
+ * savings logic of RtcDueRcf only supports 'M' rules.
+ */
+struct RtcDueRcf_TimeZone {
+  // rule[0]: Begin of the daylight savings period, offset of the standard time.
+  // rule[1]: End of the daylight savings period, offset of the daylight savings time.
+  RtcDueRcf_TzRule rule[2];
+
+  // The zone has a daylight savings period.
+  bool daylight;
+
+  // The time zone string could be parsed.
+  bool valid;
+
+  // The time zone string that has been parsed.
+  const char* tz;
+
+  /** Parse a POSIX time zone string, e.g. TZ::CET. */
+  static constexpr RtcDueRcf_TimeZone parse(const char* tz);
+
+  /** Coordinated universal time. That's the time zone before tzset(). */
+  static constexpr RtcDueRcf_TimeZone utc();
+};
+
+namespace Sam3XA {
+namespace TzConstexpr {
+
+constexpr bool isDigit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+/** A name as scanned by newlib: Up to 10 characters other than digits, ',', '+' and '-'. */
+constexpr const char* nameEnd(const char* p, const int length = 0) {
+  return length < 10 && *p != '\0' && not isDigit(*p) && *p != ',' && *p != '+' && *p != '-'
+      ? nameEnd(p + 1, length + 1) : p;
+}
+
+constexpr uint32_t number(const char* p, const uint32_t value = 0) {
+  return isDigit(*p) ? number(p + 1, value * 10 + (*p - '0')) : value;
+}
+
+constexpr const char* numberEnd(const char* p) {
+  return isDigit(*p) ? numberEnd(p + 1) : p;
+}
+
+constexpr int32_t sign(const char* p) {
+  return *p == '-' ? -1 : 1;
+}
+
+constexpr const char* afterSign(const char* p) {
+  return p + (*p == '-' || *p == '+');
+}
+
+constexpr bool hasNextField(const char* p, const int fields) {
+  return fields > 1 && *numberEnd(p) == ':' && isDigit(numberEnd(p)[1]);
+}
+
+/** Seconds of hh[:mm[:ss]]. p points to the first digit. */
+constexpr int32_t hms(const char* p, const int fields = 3, const int32_t value = 0) {
+  return hasNextField(p, fields) ? hms(numberEnd(p) + 1, fields - 1, (value + number(p)) * 60)
+      : (value + number(p)) * (fields == 3 ? 3600 : fields == 2 ? 60 : 1);
+}
+
+constexpr const char* hmsEnd(const char* p, const int fields = 3) {
+  return hasNextField(p, fields) ? hmsEnd(numberEnd(p) + 1, fields - 1) : numberEnd(p);
+}
+
+/** Position of the week and of the day of week within an M rule. */
+constexpr const char* weekPos(const char* p) {
+  return numberEnd(p + 1) + 1;
+}
+
+constexpr const char* dayPos(const char* p) {
+  return numberEnd(weekPos(p)) + 1;
+}
+
+constexpr bool isValidRule(const char* p) {
+  return *p != 'M' || (isDigit(p[1]) && *numberEnd(p + 1) == '.'
+      && isDigit(*weekPos(p)) && *numberEnd(weekPos(p)) == '.' && isDigit(*dayPos(p))
+      && number(p + 1) >= 1 && number(p + 1) <= 12
+      && number(weekPos(p)) >= 1 && number(weekPos(p)) <= 5 && number(dayPos(p)) <= 6);
+}
+
+constexpr const char* dateEnd(const char* p) {
+  return *p == 'M' ? numberEnd(dayPos(p)) : numberEnd(p + (*p == 'J'));
+}
+
+/** Transition time of a rule. Default is 02:00:00h. */
+constexpr int32_t ruleTime(const char* p) {
+  return *p == '/' && isDigit(p[1]) ? hms(p + 1) : 2 * 3600;
+}
+
+constexpr const char* timeEnd(const char* p) {
+  return *p == '/' && isDigit(p[1]) ? hmsEnd(p + 1) : p;
+}
+
+constexpr const char* ruleBegin(const char* p) {
+  return p + (*p == ',');
+}
+
+constexpr const char* ruleEnd(const char* p) {
+  return timeEnd(dateEnd(p));
+}
+
+/**
+ * A rule without a date defaults to the US rules M3.2.0 and M11.1.0
+ * like in newlib.
+ */
+constexpr RtcDueRcf_TzRule rule(const char* p, const int i, const int32_t offset) {
+  return *p == 'M' ? RtcDueRcf_TzRule{'M', static_cast<uint8_t>(number(p + 1)),
+        static_cast<uint8_t>(number(weekPos(p))), static_cast<uint16_t>(number(dayPos(p))),
+        ruleTime(dateEnd(p)), offset}
+    : isDigit(*(p + (*p == 'J'))) ? RtcDueRcf_TzRule{*p == 'J' ? 'J' : 'D', 0, 0,
+        static_cast<uint16_t>(number(p + (*p == 'J'))), ruleTime(dateEnd(p)), offset}
+    : RtcDueRcf_TzRule{'M', static_cast<uint8_t>(i == 0 ? 3 : 11), static_cast<uint8_t>(i == 0 ? 2 : 1), 0,
+        ruleTime(dateEnd(p)), offset};
+}
+
+constexpr RtcDueRcf_TimeZone invalid(const char* tz) {
+  return RtcDueRcf_TimeZone{{rule("", 0, 0), rule("", 1, 0)}, false, false, tz};
+}
+
+constexpr RtcDueRcf_TimeZone noDst(const char* tz, const int32_t stdOffset) {
+  return RtcDueRcf_TimeZone{{rule("", 0, stdOffset), rule("", 1, stdOffset)}, false, true, tz};
+}
+
+constexpr RtcDueRcf_TimeZone zone(const char* tz, const RtcDueRcf_TzRule& begin, const RtcDueRcf_TzRule& end) {
+  return RtcDueRcf_TimeZone{{begin, end}, begin.offset != end.offset, true, tz};
+}
+
+constexpr RtcDueRcf_TimeZone parseRules(const char* tz, const char* p, const int32_t stdOffset,
+    const int32_t dstOffset) {
+  return isValidRule(ruleBegin(p)) && isValidRule(ruleBegin(ruleEnd(ruleBegin(p))))
+      ? zone(tz, rule(ruleBegin(p), 0, stdOffset), rule(ruleBegin(ruleEnd(ruleBegin(p))), 1, dstOffset))
+      : invalid(tz);
+}
+
+/** Without a daylight savings offset, it is one hour ahead of the standard time. */
+constexpr RtcDueRcf_TimeZone parseDstOffset(const char* tz, const char* p, const int32_t stdOffset) {
+  return isDigit(*afterSign(p))
+      ? parseRules(tz, hmsEnd(afterSign(p)), stdOffset, sign(p) * hms(afterSign(p)))
+      : parseRules(tz, afterSign(p), stdOffset, stdOffset - 3600);
+}
+
+constexpr RtcDueRcf_TimeZone parseDstName(const char* tz, const char* p, const int32_t stdOffset) {
+  return nameEnd(p) == p ? noDst(tz, stdOffset) : parseDstOffset(tz, nameEnd(p), stdOffset);
+}
+
+constexpr RtcDueRcf_TimeZone parseStdOffset(const char* tz, const char* p) {
+  return isDigit(*afterSign(p)) ? parseDstName(tz, hmsEnd(afterSign(p)), sign(p) * hms(afterSign(p)))
+      : invalid(tz);
+}
+
+constexpr RtcDueRcf_TimeZone parseStdName(const char* tz, const char* p) {
+  return nameEnd(p) == p ? invalid(tz) : parseStdOffset(tz, nameEnd(p));
+}
+
+} // namespace TzConstexpr
+} // namespace Sam3XA
+
+constexpr RtcDueRcf_TimeZone RtcDueRcf_TimeZone::parse(const char* tz) {
+  return Sam3XA::TzConstexpr::parseStdName(tz, tz + (*tz == ':'));
+}
+
+constexpr RtcDueRcf_TimeZone RtcDueRcf_TimeZone::utc() {
+  return Sam3XA::TzConstexpr::noDst(nullptr, 0);
+}
+
+#endif /* RTCDUERCF_SRC_RTCDUERCF_TIMEZONE_H_ */
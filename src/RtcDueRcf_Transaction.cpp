@@ -0,0 +1,68 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "TM.h"
+#include "internal/core-sam-GapClose.h"
+#include "RtcDueRcf_Regs.h"
+#include "RtcDueRcf_Transaction.h"
+
+bool RtcDueRcf_Transaction::setTime(const std::tm &localTime) {
+  if(localTime.tm_year >= TM::make_tm_year(2000)) {
+    /**
+     * Call mktime in order to fix tm_yday, tm_isdst and the hour,
+     * depending on whether the time is within daylight saving
+     * period or not.
+     */
+    std::tm buffer = localTime;
+    mktime(&buffer);
+    return mCache.set(buffer);
+  }
+  return false;
+}
+
+bool RtcDueRcf_Transaction::setTime(std::time_t utcTimestamp) {
+  // Encode in a single pass without localtime_r() and mktime().
+  Sam3XA::RtcTime rtcTime;
+  rtcTime.setUtc(utcTimestamp);
+  if(rtcTime.year() >= 2000) {
+    const uint32_t rtc12HrsMode = rtcTime.rtc12hrsMode();
+    return mCache.set(RTC_TimeToTimeReg(rtcTime.hour(), rtcTime.minute(), rtcTime.second(), rtc12HrsMode),
+        RTC_DateToCalReg(rtcTime.year(), rtcTime.month(), rtcTime.day(), rtcTime.day_of_week()),
+        rtc12HrsMode);
+  }
+  return false;
+}
+
+bool RtcDueRcf_Transaction::setTime_(const std::tm &localTime) {
+  if(localTime.tm_year >= TM::make_tm_year(2000)) {
+    return mCache.set(localTime);
+  }
+  return false;
+}
+
+bool RtcDueRcf_Transaction::setAlarm(const RtcDueRcf_Alarm& alarm) {
+  using namespace Sam3XA::RtcRegsConstexpr;
+  return mCache.setAlarm(timeAlarmReg(alarm.hour, alarm.minute, alarm.second, false),
+      timeAlarmReg(alarm.hour, alarm.minute, alarm.second, true), calAlarmReg(alarm.month, alarm.day));
+}
@@ -0,0 +1,115 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_RTCDUERCF_TRANSACTION_H_
+#define RTCDUERCF_SRC_RTCDUERCF_TRANSACTION_H_
+
+#include <ctime>
+#include "internal/RtcTime.h"
+#include "RtcDueRcf_Alarm.h"
+
+/**
+ * The class RtcDueRcf_Transaction stages the time, date, hour mode and
+ * alarm, that are written to the RTC within the same RTC update. Other
+ * than calling RtcDueRcf::setTime() followed by RtcDueRcf::setAlarm(),
+ * the previous alarm can't fire on the new time and the new alarm can't
+ * fire on the previous time.
+ *
+ * Usage example:
+ *
+ *  RtcDueRcf_Transaction transaction;
+ *  transaction.setTime(time);
+ *  transaction.setAlarm(alarm);
+ *  RtcDueRcf::clock.commit(transaction);
+ */
+class RtcDueRcf_Transaction {
+  friend class RtcDueRcf;
+public:
+  /**
+   * Stage the local time. See RtcDueRcf::setTime(const std::tm&).
+   *
+   * @return true if successful. false, if date is lower than 1st of
+   *    January 2000.
+   */
+  bool setTime(const std::tm &localTime);
+
+  /**
+   * Stage the time by a UTC time stamp. See RtcDueRcf::setTime(std::time_t).
+   *
+   * @return true if successful. false, if date is lower than 1st of
+   *    January 2000.
+   */
+  bool setTime(std::time_t utcTimestamp);
+
+  /**
+   * Stage the local time transparently. See RtcDueRcf::setTime_().
+   *
+   * @return true if successful. false, if date is lower than 1st of
+   *    January 2000.
+   */
+  bool setTime_(const std::tm &localTime);
+
+  /**
+   * Stage a local time and date that has been converted to RTC register
+   * contents at compile time. See RtcDueRcf::setTime<RtcRegs>().
+   *
+   * @param RTC_REGS An RtcRegs type.
+   */
+  template<typename RTC_REGS> void setTime() {
+    mCache.set(RTC_REGS::timeReg, RTC_REGS::calReg, RTC_REGS::rtc12HrsMode);
+  }
+
+  /**
+   * Stage the alarm time and date.
+   *
+   * @return true, if the alarm is valid. Otherwise false.
+   */
+  bool setAlarm(const RtcDueRcf_Alarm& alarm);
+
+  /**
+   * Stage an alarm that has been converted to RTC register contents at
+   * compile time. See RtcDueRcf::setAlarm<RtcAlarmRegs>().
+   *
+   * @param RTC_ALARM_REGS An RtcAlarmRegs type.
+   *
+   * @return true, if the alarm is valid. Otherwise false.
+   */
+  template<typename RTC_ALARM_REGS> bool setAlarm() {
+    return mCache.setAlarm(RTC_ALARM_REGS::timeAlarmReg24, RTC_ALARM_REGS::timeAlarmReg12,
+        RTC_ALARM_REGS::calAlarmReg);
+  }
+
+  /** @return true, if a time has been staged. */
+  bool hasTime() const {return mCache.isValid();}
+
+  /** @return true, if an alarm has been staged. */
+  bool hasAlarm() const {return mCache.hasAlarm();}
+
+private:
+  Sam3XA::RtcSetTimeCache mCache;
+};
+
+#endif /* RTCDUERCF_SRC_RTCDUERCF_TRANSACTION_H_ */
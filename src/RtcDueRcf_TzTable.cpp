@@ -0,0 +1,99 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "RtcDueRcf_TzTable.h"
+
+namespace {
+
+/** std::time_t may have 32 bits, the table covers times beyond 2038. */
+std::time_t toTimeStamp(const int64_t utc) {
+  return utc > RtcDueRcf_TzTable::TIME_MAX ? RtcDueRcf_TzTable::TIME_MAX : static_cast<std::time_t>(utc);
+}
+
+uint32_t decode(const uint8_t*& data) {
+  uint32_t result = 0;
+  unsigned shift = 0;
+  uint8_t byte;
+  do {
+    byte = *data++;
+    result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    shift += 7;
+  } while(byte & 0x80);
+  return result;
+}
+
+} // anonymous namespace
+
+constexpr unsigned RtcDueRcf_TzTable::TYPE_BITS;
+constexpr unsigned RtcDueRcf_TzTable::BLOCK_SIZE;
+constexpr std::time_t RtcDueRcf_TzTable::TIME_MIN;
+constexpr std::time_t RtcDueRcf_TzTable::TIME_MAX;
+
+const RtcDueRcf_TzTable::Type& RtcDueRcf_TzTable::lookup(const std::time_t utcTimestamp,
+    std::time_t& validFrom, std::time_t& validUntil) const {
+  const int64_t utc = utcTimestamp;
+  validFrom = TIME_MIN;
+  validUntil = TIME_MAX;
+
+  // The first block, that begins after utc.
+  size_t lower = 0;
+  size_t upper = blockCount;
+  while(lower < upper) {
+    const size_t mid = (lower + upper) / 2;
+    if(blocks[mid].utc <= utc) {
+      lower = mid + 1;
+    } else {
+      upper = mid;
+    }
+  }
+  if(lower == 0) {
+    if(blockCount > 0) {
+      validUntil = toTimeStamp(blocks[0].utc);
+    }
+    return types[initialType];
+  }
+
+  // Decode the block, that utc is within.
+  const size_t block = lower - 1;
+  const size_t remaining = transitionCount - block * BLOCK_SIZE;
+  const size_t n = remaining < BLOCK_SIZE ? remaining : BLOCK_SIZE;
+  const uint8_t* p = data + blocks[block].pos;
+  int64_t transition = blocks[block].utc;
+  uint8_t type = initialType;
+  for(size_t i = 0; i < n; i++) {
+    const uint32_t value = decode(p);
+    const int64_t next = transition + static_cast<int64_t>(value >> TYPE_BITS) * 60;
+    if(next > utc) {
+      validUntil = toTimeStamp(next);
+      return types[type];
+    }
+    transition = next;
+    type = value & ((1u << TYPE_BITS) - 1);
+    validFrom = toTimeStamp(transition);
+  }
+  if(lower < blockCount) {
+    validUntil = toTimeStamp(blocks[lower].utc);
+  }
+  return types[type];
+}
@@ -0,0 +1,103 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_RTCDUERCF_TZTABLE_H_
+#define RTCDUERCF_SRC_RTCDUERCF_TZTABLE_H_
+
+#include <stdint.h>
+#include <ctime>
+#include <limits>
+
+/**
+ * The history of a time zone as compiled from the tz database. Other
+ * than the rule pair of a POSIX time zone string, it knows each UTC
+ * offset change within the compiled years. So time stamps before and
+ * after a change of the rules convert correctly.
+ *
+ * The tables are generated by extras/host/RtcDueRcf_TzTableGen.py:
+ *
+ *  python3 RtcDueRcf_TzTableGen.py Europe/Berlin America/New_York > TzTables.h
+ *
+ * and kept in flash, since they are const. Usage example:
+ *
+ *  #include "TzTables.h"
+ *  const int berlin = RtcDueRcf::clock.registerTimeZone(TZ::TABLES::Europe_Berlin);
+ *
+ * Format: The transitions are delta encoded. Each one is a little endian
+ * base 128 number of (minutes since the previous transition << TYPE_BITS
+ * | type index). They are grouped into blocks of BLOCK_SIZE transitions.
+ * The first transition of a block has the delta 0 to the UTC time of
+ * the block. A lookup searches the blocks binary and decodes at most
+ * one block.
+ */
+struct RtcDueRcf_TzTable {
+  static constexpr unsigned TYPE_BITS = 3;
+  static constexpr unsigned BLOCK_SIZE = 16;
+
+  // Before the first and after the last transition. The parentheses
+  // prevent the expansion of Arduino's min() and max() macros.
+  static constexpr std::time_t TIME_MIN = (std::numeric_limits<std::time_t>::min)();
+  static constexpr std::time_t TIME_MAX = (std::numeric_limits<std::time_t>::max)();
+
+  struct Type {
+    int32_t offset; // Seconds west of UTC, like RtcDueRcf_TzRule::offset.
+    uint8_t isdst;  // 1: Daylight savings time.
+  };
+
+  struct Block {
+    uint32_t utc;   // UTC time stamp of the first transition of the block.
+    uint16_t pos;   // Position of the first transition within data.
+  };
+
+  // IANA name of the time zone.
+  const char* name;
+
+  // Up to 1 << TYPE_BITS different offsets.
+  const Type* types;
+
+  const Block* blocks;
+  uint16_t blockCount;
+
+  // The encoded transitions.
+  const uint8_t* data;
+  uint16_t transitionCount;
+
+  // Type index before the first transition.
+  uint8_t initialType;
+
+  /**
+   * Look up the type, that applies to a UTC time stamp.
+   *
+   * @param utcTimestamp The UTC time stamp.
+   * @param[out] validFrom The UTC time stamp of the transition to the
+   *    type. TIME_MIN before the first transition.
+   * @param[out] validUntil The UTC time stamp of the next transition.
+   *    TIME_MAX after the last transition.
+   */
+  const Type& lookup(const std::time_t utcTimestamp, std::time_t& validFrom, std::time_t& validUntil) const;
+};
+
+#endif /* RTCDUERCF_SRC_RTCDUERCF_TZTABLE_H_ */
@@ -0,0 +1,96 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include <ctime>
+#include "core-sam-GapClose.h"
+#include "RtcDstTransitionCache.h"
+#include "RtcTimeZone.h"
+
+namespace {
+
+/**
+ * Local time of a transition rule within year in the representation
+ * of the RTC time that it is compared against.
+ *
+ * @param shift Seconds to be added to the transition time.
+ */
+Sam3XA::RtcTime transitionTime(const RtcDueRcf_TzRule& tzrule, const uint16_t year,
+    const int32_t shift, const uint8_t rtc12hrsMode) {
+  Sam3XA::RtcTime result;
+  result.set(static_cast<std::time_t>(Sam3XA::RtcTimeZone::transitionDay(tzrule, year)) * 24 * 60 * 60
+      + tzrule.s + shift, rtc12hrsMode);
+  return result;
+}
+
+} // anonymous namespace
+
+namespace Sam3XA {
+
+void RtcDstTransitionCache::update(const RtcTime& rtcTime, const uint32_t timeZoneGeneration) {
+  mTransitionKey = UINT64_MAX;
+  const RtcDueRcf_TimeZone& tz = RtcTimeZone::rules();
+  if(tz.daylight) {
+    // The RTC holding daylight savings time awaits the end of the
+    // daylight savings period and vice versa. The begin is compared
+    // against the standard time plus the lead time.
+    const uint8_t rtc12hrsMode = rtcTime.rtc12hrsMode();
+    const RtcDueRcf_TzRule& tzrule = tz.rule[rtc12hrsMode ? 1 : 0];
+    const int32_t shift = rtc12hrsMode ? 0 : -RtcTime::DST_BEGIN_LEAD_TIME;
+
+    const uint64_t now = rtcTime.chronoKey();
+    uint64_t transition = transitionTime(tzrule, rtcTime.year(), shift, rtc12hrsMode).chronoKey();
+    if(transition <= now) {
+      transition = transitionTime(tzrule, rtcTime.year() + 1, shift, rtc12hrsMode).chronoKey();
+    }
+    mTransitionKey = transition;
+  }
+  mTimeZoneGeneration = timeZoneGeneration;
+  mValid = true;
+}
+
+bool RtcDstTransitionCache::check(const RtcTime& rtcTime, const uint32_t timeZoneGeneration,
+    RtcTime& dueTimeAndDate) {
+  if(not isCheckDue(rtcTime, timeZoneGeneration)) {
+    return false;
+  }
+  const bool request = dueTimeAndDate.isDstRtcRequest(rtcTime);
+  if(not request) {
+    update(rtcTime, timeZoneGeneration);
+  }
+  return request;
+}
+
+uint32_t RtcDstTransitionCache::selectWakeup(const RtcTime& rtcTime, const uint32_t timeZoneGeneration) const {
+  // The next minute change event happens within 60 seconds, the next
+  // hour change event within 3600 seconds.
+  if(isCheckDue(rtcTime, timeZoneGeneration) || (rtcTime + 60).chronoKey() >= mTransitionKey) {
+    return RTC_WAKEUP_SECOND;
+  }
+  if((rtcTime + 3600).chronoKey() >= mTransitionKey) {
+    return RTC_CR_TIMEVSEL_MINUTE;
+  }
+  return RTC_CR_TIMEVSEL_HOUR;
+}
+
+} // namespace Sam3XA
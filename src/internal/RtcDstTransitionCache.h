@@ -0,0 +1,120 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_INTERNAL_RTCDSTTRANSITIONCACHE_H_
+#define RTCDUERCF_SRC_INTERNAL_RTCDSTTRANSITIONCACHE_H_
+
+#include <stdint.h>
+#include "RtcTime.h"
+
+namespace Sam3XA {
+
+/**
+ * The next daylight savings transition in RTC local representation.
+ * While the RTC time is before it, the RTC hour mode is known to be
+ * correct and the daylight savings rules need not be evaluated. So the
+ * check once a second boils down to a single integer compare.
+ *
+ * The transition is calculated from the time zone rules after a check
+ * did not lead to a request. It has to be recalculated when the RTC time
+ * has been set or the time zone has changed. Both invalidate the cache.
+ */
+class RtcDstTransitionCache {
+public:
+  /**
+   * @param rtcTime The time that has been read from the RTC.
+   * @param timeZoneGeneration Incremented upon each time zone change.
+   *
+   * @return true, if the daylight savings rules must be evaluated
+   *    for rtcTime.
+   */
+  bool isCheckDue(const RtcTime& rtcTime, const uint32_t timeZoneGeneration) const {
+    return not mValid || mTimeZoneGeneration != timeZoneGeneration
+        || rtcTime.chronoKey() >= mTransitionKey;
+  }
+
+  /**
+   * Calculate the next transition after rtcTime. To be called, when
+   * the RTC hour mode has been found correct for rtcTime, i.e.
+   * RtcTime::isDstRtcRequest() returned false.
+   *
+   * @param rtcTime The time that has been read from the RTC.
+   * @param timeZoneGeneration The time zone generation that the
+   *    rules have been evaluated for.
+   */
+  void update(const RtcTime& rtcTime, const uint32_t timeZoneGeneration);
+
+  /**
+   * The daylight savings check of the second interrupt. Evaluates the
+   * rules, if isCheckDue(). If the RTC hour mode is found correct, the
+   * next transition is calculated. Otherwise the cache is left as it is
+   * until the RTC has been set.
+   *
+   * @param rtcTime The time that has been read from the RTC.
+   * @param timeZoneGeneration Incremented upon each time zone change.
+   * @param dueTimeAndDate Receives the time to be written to the RTC,
+   *    if true is returned.
+   *
+   * @return true, if the RTC must be set to dueTimeAndDate.
+   */
+  bool check(const RtcTime& rtcTime, const uint32_t timeZoneGeneration, RtcTime& dueTimeAndDate);
+
+  /**
+   * Select the RTC interrupt, that wakes up the CPU for the next
+   * check, when the check is event driven. Hour and minute change
+   * events count down to the transition. The second interrupt is
+   * selected within the last minute before it.
+   *
+   * @param rtcTime The time that has been read from the RTC.
+   * @param timeZoneGeneration Incremented upon each time zone change.
+   *
+   * @return RTC_WAKEUP_SECOND, RTC_CR_TIMEVSEL_MINUTE or
+   *    RTC_CR_TIMEVSEL_HOUR. See RTC_SelectWakeup().
+   */
+  uint32_t selectWakeup(const RtcTime& rtcTime, const uint32_t timeZoneGeneration) const;
+
+  /** Let the next check evaluate the daylight savings rules. */
+  void invalidate() {mValid = false;}
+
+  /** @return true, if a transition has been calculated. */
+  bool isValid() const {return mValid;}
+
+  /**
+   * @return The chronoKey() of the RTC time, upon which the next
+   *    check is due. UINT64_MAX, if the time zone has no daylight
+   *    savings.
+   */
+  uint64_t transitionKey() const {return mTransitionKey;}
+
+private:
+  bool mValid = false;
+  uint32_t mTimeZoneGeneration = 0;
+  uint64_t mTransitionKey = 0;
+};
+
+} // namespace Sam3XA
+
+#endif /* RTCDUERCF_SRC_INTERNAL_RTCDSTTRANSITIONCACHE_H_ */
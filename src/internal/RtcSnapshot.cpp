@@ -0,0 +1,64 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "RtcSnapshot.h"
+#include "RtcTimeZone.h"
+#include "../RtcDueRcf_Regs.h"
+
+namespace {
+
+constexpr int32_t SECSPERMIN = 60;
+constexpr int32_t SECSPERHOUR = SECSPERMIN * 60;
+constexpr int32_t SECSPERDAY = SECSPERHOUR * 24;
+
+} // anonymous namespace
+
+namespace Sam3XA {
+
+std::time_t RtcSnapshot::toLocalTimeStamp(const uint32_t timeReg, const uint32_t calReg,
+    const uint32_t rtc12HrsMode) {
+  // Decode by the bcd codec of the RTC register access functions.
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+  RTC_TimeRegToTime(timeReg, nullptr, &hour, &minute, &second, rtc12HrsMode & RTC_MR_HRMOD);
+
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  RTC_CalRegToDate(calReg, &year, &month, &day, nullptr);
+
+  const std::time_t days = RtcRegsConstexpr::daysFromCivil(year, month, day);
+  return days * SECSPERDAY + static_cast<int32_t>(hour * SECSPERHOUR + minute * SECSPERMIN + second);
+}
+
+std::time_t RtcSnapshot::localToUtcOffset(const uint32_t isdst) {
+  return RtcTimeZone::localToUtcOffset(isdst);
+}
+
+std::time_t RtcSnapshot::utcTimeStamp() const {
+  return localTimeStamp() + localToUtcOffset(rtc12hrsMode());
+}
+
+} // namespace Sam3XA
@@ -0,0 +1,165 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_INTERNAL_RTCSNAPSHOT_H_
+#define RTCDUERCF_SRC_INTERNAL_RTCSNAPSHOT_H_
+
+#include <stdint.h>
+#include <ctime>
+#include "core-sam-GapClose.h"
+
+namespace Sam3XA {
+
+/**
+ * A consistent raw copy of the RTC time, calendar and mode registers.
+ * The fields are decoded on access only. The RTC Valid Entry Register
+ * and the alarm enabled flags are only read from the RTC when asked for.
+ */
+class RtcSnapshot {
+public:
+  RtcSnapshot() : mRegs{0, 0, 0} {}
+  explicit RtcSnapshot(const RtcTimeSnapshot& regs) : mRegs(regs) {}
+
+  /**
+   * Read RTC_TIMR, RTC_CALR and RTC_MR from the RTC with a bounded
+   * number of re-reads.
+   *
+   * @param maxRetries Maximum number of re-reads.
+   *
+   * @return The number of re-reads or RTC_READ_UNSTABLE. The snapshot
+   *    is left unchanged then.
+   */
+  int readFromRtc(const unsigned maxRetries = RTC_READ_RETRY_LIMIT) {
+    return RTC_ReadTimeSnapshot(RTC, &mRegs, maxRetries);
+  }
+
+  inline uint32_t timeReg() const {return mRegs.timr;}
+  inline uint32_t calReg() const {return mRegs.calr;}
+
+  //  0: RTC runs in 24-hrs mode.
+  //  1: RTC runs in 12-hrs mode.
+  inline uint8_t rtc12hrsMode() const {return mRegs.mr & RTC_MR_HRMOD;}
+
+  /** @return Hour in 24-hrs representation [0..23]. */
+  uint8_t hour() const {
+    uint8_t result;
+    RTC_TimeRegToTime(mRegs.timr, nullptr, &result, nullptr, nullptr, rtc12hrsMode());
+    return result;
+  }
+
+  uint8_t minute() const {
+    uint8_t result;
+    RTC_TimeRegToTime(mRegs.timr, nullptr, nullptr, &result, nullptr, rtc12hrsMode());
+    return result;
+  }
+
+  uint8_t second() const {
+    uint8_t result;
+    RTC_TimeRegToTime(mRegs.timr, nullptr, nullptr, nullptr, &result, rtc12hrsMode());
+    return result;
+  }
+
+  /** @return 4 digits ad year. */
+  uint16_t year() const {
+    uint16_t result;
+    RTC_CalRegToDate(mRegs.calr, &result, nullptr, nullptr, nullptr);
+    return result;
+  }
+
+  /** @return 1..12 */
+  uint8_t month() const {
+    uint8_t result;
+    RTC_CalRegToDate(mRegs.calr, nullptr, &result, nullptr, nullptr);
+    return result;
+  }
+
+  /** @return 1..31 */
+  uint8_t day() const {
+    uint8_t result;
+    RTC_CalRegToDate(mRegs.calr, nullptr, nullptr, &result, nullptr);
+    return result;
+  }
+
+  /** @return 1=SUN ..7=SAT */
+  uint8_t day_of_week() const {
+    uint8_t result;
+    RTC_CalRegToDate(mRegs.calr, nullptr, nullptr, nullptr, &result);
+    return result;
+  }
+
+  /**
+   * Convert the register contents directly to a time stamp that
+   * represents the local time, as if the local time were UTC. No
+   * std::tm and no newlib time functions are involved.
+   */
+  std::time_t localTimeStamp() const {
+    return toLocalTimeStamp(mRegs.timr, mRegs.calr, rtc12hrsMode());
+  }
+
+  /**
+   * Convert the register contents directly to a UTC time stamp. The
+   * RTC 12-hrs mode is taken as daylight savings flag. The offsets
+   * are taken from the already parsed time zone information.
+   * Prerequisite: time zone is set by RtcDueRcf::tzset().
+   */
+  std::time_t utcTimeStamp() const;
+
+  /**
+   * Decode the RTC_TIMR and RTC_CALR register contents to a local time
+   * stamp. The fields are decoded by RTC_TimeRegToTime() and
+   * RTC_CalRegToDate(), i.e. by the same bcd codec as any other access.
+   *
+   * @param timeReg The contents of the RTC_TIMR register.
+   * @param calReg The contents of the RTC_CALR register.
+   * @param rtc12HrsMode The hour mode of timeReg:
+   *    0: 24-hrs mode.
+   *    1: 12-hrs mode.
+   */
+  static std::time_t toLocalTimeStamp(const uint32_t timeReg, const uint32_t calReg,
+      const uint32_t rtc12HrsMode);
+
+  /**
+   * The offset in seconds to be added to a local time stamp to
+   * get the UTC time stamp.
+   *
+   * @param isdst 0: standard time, 1: daylight savings time.
+   */
+  static std::time_t localToUtcOffset(const uint32_t isdst);
+
+  /** Read the RTC Valid Entry Register from the RTC. */
+  static unsigned validEntryRegister() {return RTC_GetValidEntry(RTC);}
+
+  /** Read the alarm enabled flags from the RTC. */
+  static unsigned alarmEnabledFlags() {return RTC_GetAlarmEnRetFlags(RTC);}
+
+private:
+  RtcTimeSnapshot mRegs;
+};
+
+} // namespace Sam3XA
+
+#endif /* RTCDUERCF_SRC_INTERNAL_RTCSNAPSHOT_H_ */
@@ -24,7 +24,9 @@
 
 
 #include "core-sam-GapClose.h"
+#include "RtcSnapshot.h"
 #include "RtcTime.h"
+#include "RtcTimeZone.h"
 
 #ifndef RTC_DEBUG_HOUR_MODE
   #define RTC_DEBUG_HOUR_MODE false
@@ -132,7 +134,10 @@ int calcWdayOccurranceInMonth(int tm_wday, const Sam3XA::RtcTime& rtcTime) {
 }
 
 inline int calcMdayOfNextWdayOccurance(int tm_wday, const Sam3XA::RtcTime& rtcTime) {
-  const int daysUntilNextOccurranceOfWday = 7 - (tm_wday - rtcTime.tm_wday());
+  int daysUntilNextOccurranceOfWday = tm_wday - rtcTime.tm_wday();
+  if(daysUntilNextOccurranceOfWday <= 0) {
+    daysUntilNextOccurranceOfWday += 7;
+  }
   return rtcTime.tm_mday() + daysUntilNextOccurranceOfWday;
 }
 
@@ -152,7 +157,7 @@ inline int32_t expiredSecondsWithinDay(const Sam3XA::RtcTime& rtcTime) {
  * rtcAheadTime is 0 or positive when checking against dst begin rule.
  * rtcAheadTime is 0 or negative when checking against dst end rule.
  */
-int hasTransitionedDstRule(const Sam3XA::RtcTime* const rtcTime, const __tzrule_struct* const tzrule) {
+int hasTransitionedDstRule(const Sam3XA::RtcTime* const rtcTime, const RtcDueRcf_TzRule* const tzrule) {
   int result = 0;
   if(rtcTime->month() >= tzrule->m) {
     if(rtcTime->month() == tzrule->m) {
@@ -160,7 +165,11 @@ int hasTransitionedDstRule(const Sam3XA::RtcTime* const rtcTime, const __tzrule_
       const bool dayMatch = (occuranceOfTzRuleWdayWithinMonthOfRtcTime >= tzrule->n) ||
         (tzrule->n >= 5 && isLastWdayWithinMonth(tzrule->d, *rtcTime));
       if(dayMatch) {
-        if(expiredSecondsWithinDay(*rtcTime) >= tzrule->s) {
+        // The time of the rule only matters at the day of the transition.
+        const bool isTransitionDay = (rtcTime->tm_wday() == tzrule->d) &&
+          ((occuranceOfTzRuleWdayWithinMonthOfRtcTime == tzrule->n) ||
+              (tzrule->n >= 5 && isLastWdayWithinMonth(tzrule->d, *rtcTime)));
+        if(not isTransitionDay || expiredSecondsWithinDay(*rtcTime) >= tzrule->s) {
           result = 1;
         }
       }
@@ -205,7 +214,9 @@ inline int yday(const Sam3XA::RtcTime& rtcTime) {
 
 namespace Sam3XA {
 RtcSetTimeCache::RtcSetTimeCache() :
-    mTimeReg(RTC_INVALID_TIME_REG), mCalReg(RTC_INVALID_CAL_REG), mRtc12HrsMode(0) {
+    mTimeReg(RTC_INVALID_TIME_REG), mCalReg(RTC_INVALID_CAL_REG), mRtc12HrsMode(0),
+    mTimeAlarmReg24(RTC_INVALID_TIME_REG), mTimeAlarmReg12(RTC_INVALID_TIME_REG),
+    mCalAlarmReg(RTC_INVALID_CAL_REG) {
 }
 
 
@@ -214,10 +225,9 @@ bool RtcSetTimeCache::isValid() const {
 }
 
 bool RtcSetTimeCache::set(const RtcTime &rtcTime) {
-  mTimeReg = RTC_TimeToTimeReg(rtcTime.hour(), rtcTime.mMinute, rtcTime.mSecond, rtcTime.mRtc12hrsMode);
-  mCalReg = RTC_DateToCalReg(rtcTime.mYear, rtcTime.mMonth, rtcTime.mDayOfMonth, rtcTime.mDayOfWeekDay);
-  mRtc12HrsMode = rtcTime.mRtc12hrsMode;
-  return isValid();
+  return set(RTC_TimeToTimeReg(rtcTime.hour(), rtcTime.mMinute, rtcTime.mSecond, rtcTime.mRtc12hrsMode),
+      RTC_DateToCalReg(rtcTime.mYear, rtcTime.mMonth, rtcTime.mDayOfMonth, rtcTime.mDayOfWeekDay),
+      rtcTime.mRtc12hrsMode);
 }
 
 bool RtcSetTimeCache::set(const std::tm &tm) {
@@ -226,6 +236,40 @@ bool RtcSetTimeCache::set(const std::tm &tm) {
   return set(rtcTime);
 }
 
+bool RtcSetTimeCache::set(const uint32_t timeReg, const uint32_t calReg, const uint32_t rtc12HrsMode) {
+  if(RTC_IsValidTimeReg(timeReg, rtc12HrsMode) && RTC_IsValidCalReg(calReg)) {
+    mTimeReg = timeReg;
+    mCalReg = calReg;
+    mRtc12HrsMode = rtc12HrsMode;
+    return true;
+  }
+  return false;
+}
+
+bool RtcSetTimeCache::hasAlarm() const {
+  return mCalAlarmReg != RTC_INVALID_CAL_REG;
+}
+
+void RtcSetTimeCache::inheritAlarm(const RtcSetTimeCache& other) {
+  if(not hasAlarm()) {
+    mTimeAlarmReg24 = other.mTimeAlarmReg24;
+    mTimeAlarmReg12 = other.mTimeAlarmReg12;
+    mCalAlarmReg = other.mCalAlarmReg;
+  }
+}
+
+bool RtcSetTimeCache::setAlarm(const uint32_t timeAlarmReg24, const uint32_t timeAlarmReg12,
+    const uint32_t calAlarmReg) {
+  if(RTC_IsValidTimeAlarmReg(timeAlarmReg24, 0) && RTC_IsValidTimeAlarmReg(timeAlarmReg12, 1)
+      && RTC_IsValidCalAlarmReg(calAlarmReg)) {
+    mTimeAlarmReg24 = timeAlarmReg24;
+    mTimeAlarmReg12 = timeAlarmReg12;
+    mCalAlarmReg = calAlarmReg;
+    return true;
+  }
+  return false;
+}
+
 RtcTime RtcSetTimeCache::toRtcTime() const {
   RtcTime result;
 
@@ -241,15 +285,15 @@ RtcTime RtcSetTimeCache::toRtcTime() const {
 }
 
 inline const Sam3XA::RtcTime* RtcTime::getDstBeginCompareTime(Sam3XA::RtcTime& stdTime, const Sam3XA::RtcTime& dstTime,
-    const int32_t dstTimeShift, Sam3XA::RtcTime& buffer) {
+    const int32_t dstTimeShift, const int32_t dstBeginLeadTime, Sam3XA::RtcTime& buffer) {
 
   if(stdTime.isValid()) {
-    buffer = stdTime + 1; // ensure that dst is recognized 1 second early
+    buffer = stdTime + dstBeginLeadTime; // ensure that dst is recognized early
     return &buffer;
   }
 
   if(dstTime.isValid()) {
-    buffer = dstTime - (dstTimeShift - 1);
+    buffer = dstTime - (dstTimeShift - dstBeginLeadTime);
     buffer.mRtc12hrsMode = 0;
     return &buffer;
   }
@@ -273,14 +317,15 @@ inline const Sam3XA::RtcTime* RtcTime::getDstEndCompareTime(const Sam3XA::RtcTim
   return nullptr;
 }
 
-inline int RtcTime::isdst(Sam3XA::RtcTime& stdTime, Sam3XA::RtcTime& dstTime) {
-  if(_daylight) {
+inline int RtcTime::isdst(Sam3XA::RtcTime& stdTime, Sam3XA::RtcTime& dstTime,
+    const int32_t dstBeginLeadTime) {
+  const RtcDueRcf_TimeZone& tz = RtcTimeZone::rules();
+  if(tz.daylight) {
 #if MEASURE_Sam3XA_RtcTime_isdst
     const uint32_t s = micros();
 #endif
-    const __tzinfo_type * const tz = __gettzinfo ();
-    const __tzrule_struct* const tzrule_DstBegin = &tz->__tzrule[0];
-    const __tzrule_struct* const tzrule_DstEnd = &tz->__tzrule[1];
+    const RtcDueRcf_TzRule* const tzrule_DstBegin = &tz.rule[0];
+    const RtcDueRcf_TzRule* const tzrule_DstEnd = &tz.rule[1];
     const int32_t dstTimeShift = (tzrule_DstBegin->offset - tzrule_DstEnd->offset);
 
     int result = tzrule_DstBegin->m >= tzrule_DstEnd->m;
@@ -289,15 +334,18 @@ inline int RtcTime::isdst(Sam3XA::RtcTime& stdTime, Sam3XA::RtcTime& dstTime) {
       const Sam3XA::RtcTime*const dstEndCompareTime = getDstEndCompareTime(stdTime, dstTime, dstTimeShift);
       if(not hasTransitionedDstRule(dstEndCompareTime, tzrule_DstEnd)) {
         Sam3XA::RtcTime buffer;
-        const Sam3XA::RtcTime* const dstBeginCompareTime = getDstBeginCompareTime(stdTime, dstTime, dstTimeShift, buffer);
-        result = hasTransitionedDstRule(dstBeginCompareTime, tzrule_DstBegin);
+        const Sam3XA::RtcTime* const dstBeginCompareTime = getDstBeginCompareTime(stdTime, dstTime, dstTimeShift, dstBeginLeadTime, buffer);
+        // Within the last hour of the year, the end compare time is already
+        // in the next year. The end of the begin compare time's year has passed then.
+        result = dstBeginCompareTime->year() == dstEndCompareTime->year()
+            && hasTransitionedDstRule(dstBeginCompareTime, tzrule_DstBegin);
       }
     } else {
       // South hemisphere
       const Sam3XA::RtcTime*const dstEndCompareTime = getDstEndCompareTime(stdTime, dstTime, dstTimeShift);
       if(hasTransitionedDstRule(dstEndCompareTime, tzrule_DstEnd)) {
         Sam3XA::RtcTime buffer;
-        const Sam3XA::RtcTime* const dstBeginCompareTime = getDstBeginCompareTime(stdTime, dstTime, dstTimeShift, buffer);
+        const Sam3XA::RtcTime* const dstBeginCompareTime = getDstBeginCompareTime(stdTime, dstTime, dstTimeShift, dstBeginLeadTime, buffer);
         result = hasTransitionedDstRule(dstBeginCompareTime, tzrule_DstBegin);
       }
     }
@@ -350,9 +398,8 @@ Sam3XA::RtcTime RtcTime::operator+(const time_t sec) const {
 #if  MEASURE_RtcTime_arithmethic_operators
   const uint32_t startTime = micros();
 #endif
-  std::time_t timeStamp = toTimeStamp() + sec;
   Sam3XA::RtcTime result;
-  result.set(timeStamp, mRtc12hrsMode);
+  result.setShifted(*this, sec);
 #if  MEASURE_RtcTime_arithmethic_operators
   const uint32_t execTime = micros() - startTime;
   Serial.print(__FUNCTION__);
@@ -367,9 +414,8 @@ Sam3XA::RtcTime RtcTime::operator-(const time_t sec) const {
 #if  MEASURE_RtcTime_arithmethic_operators
   const uint32_t startTime = micros();
 #endif
-  std::time_t timeStamp = toTimeStamp() - sec;
   Sam3XA::RtcTime result;
-  result.set(timeStamp, mRtc12hrsMode);
+  result.setShifted(*this, -sec);
 #if  MEASURE_RtcTime_arithmethic_operators
   const uint32_t execTime = micros() - startTime;
   Serial.print(__FUNCTION__);
@@ -380,6 +426,61 @@ Sam3XA::RtcTime RtcTime::operator-(const time_t sec) const {
   return result;
 }
 
+void RtcTime::setShifted(const RtcTime& other, const std::time_t sec) {
+  if(sec > -SECSPERDAY && sec < SECSPERDAY) {
+    *this = other;
+    mState = VALID;
+    addSecondsWithinDay(sec);
+  } else {
+    set(other.toTimeStamp() + sec, other.mRtc12hrsMode);
+  }
+}
+
+void RtcTime::addSecondsWithinDay(const int32_t sec) {
+  int32_t seconds = expiredSecondsWithinDay(*this) + sec;
+  int dayCarry = 0;
+  if(seconds < 0) {
+    seconds += SECSPERDAY;
+    dayCarry = -1;
+  } else if(seconds >= SECSPERDAY) {
+    seconds -= SECSPERDAY;
+    dayCarry = 1;
+  }
+
+  mHour = seconds / SECSPERHOUR;
+  seconds -= mHour * SECSPERHOUR;
+  mMinute = seconds / SECSPERMIN;
+  mSecond = seconds - mMinute * SECSPERMIN;
+
+  if(dayCarry > 0) {
+    mDayOfWeekDay = mDayOfWeekDay % DAYSPERWEEK + 1;
+    if(mDayOfMonth < month_lengths[isLeapYear(mYear)][tm_mon()]) {
+      ++mDayOfMonth;
+    } else {
+      mDayOfMonth = 1;
+      if(mMonth < 12) {
+        ++mMonth;
+      } else {
+        mMonth = 1;
+        ++mYear;
+      }
+    }
+  } else if(dayCarry < 0) {
+    mDayOfWeekDay = (mDayOfWeekDay + DAYSPERWEEK - 2) % DAYSPERWEEK + 1;
+    if(mDayOfMonth > 1) {
+      --mDayOfMonth;
+    } else {
+      if(mMonth > 1) {
+        --mMonth;
+      } else {
+        mMonth = 12;
+        --mYear;
+      }
+      mDayOfMonth = month_lengths[isLeapYear(mYear)][tm_mon()];
+    }
+  }
+}
+
 uint8_t RtcTime::tmDayOfWeek(const std::tm &time) {
   /** Calling mktime will calculate and set tm_wday. */
   std::tm t = time;
@@ -429,6 +530,19 @@ void RtcTime::set(const std::time_t timestamp, const uint8_t isdst)
   mState = VALID;
 }
 
+void RtcTime::setUtc(const std::time_t utcTimestamp) {
+  RtcTime stdTime;
+  stdTime.set(utcTimestamp - RtcTimeZone::rules().rule[0].offset, 0);
+  RtcTime dstTime;
+  // The time is set exactly, so don't recognize the begin of dst early.
+  if(isdst(stdTime, dstTime, 0)) {
+    // isdst() has derived dstTime from stdTime.
+    *this = dstTime;
+  } else {
+    *this = stdTime;
+  }
+}
+
 void RtcTime::set(const std::tm &time) {
 #if DEBUG_SET_RtcTime
 	Serial.print("RtcTime::");
@@ -452,10 +566,18 @@ void RtcTime::set(const std::tm &time) {
 }
 
 void RtcTime::get(std::tm &time) const {
+  getTimeOfDay(time);
+  getDate(time);
+}
+
+void RtcTime::getTimeOfDay(std::tm &time) const {
   time.tm_isdst = rtc12hrsMode();
   time.tm_hour = tm_hour();
   time.tm_min = tm_min();
   time.tm_sec = tm_sec();
+}
+
+void RtcTime::getDate(std::tm &time) const {
   time.tm_year = tm_year();
   time.tm_mon = tm_mon();
   time.tm_mday = tm_mday();
@@ -463,10 +585,9 @@ void RtcTime::get(std::tm &time) const {
   time.tm_yday = yday(*this);
 }
 
-bool RtcTime::isDstRtcRequest() {
+bool RtcTime::isDstRtcRequest(const RtcTime& rtcTimeRead) {
   bool result = false;
-  RtcTime rtcTime;
-  rtcTime.readFromRtc_();
+  RtcTime rtcTime = rtcTimeRead;
 
   if(rtcTime.isValid()) {
   #if DEBUG_SET_RtcTime
@@ -517,7 +638,7 @@ bool RtcTime::isDstRtcRequest() {
   return result;
 }
 
-void RtcSetTimeCache::writeToRtc() const {
+bool RtcSetTimeCache::writeToRtc() const {
 #if DEBUG_SET_RtcTime || DEBUG_writeToRtc || RTC_DEBUG_HOUR_MODE
 	Serial.print("RtcTime::");
 	Serial.print(__FUNCTION__);
@@ -538,7 +659,10 @@ void RtcSetTimeCache::writeToRtc() const {
 	}
 	Serial.println();
 #endif
-  const unsigned rtcValidEntryRegister = RTC_SetTimeAndDate(RTC, mTimeReg, mCalReg, mRtc12HrsMode);
+  const unsigned rtcValidEntryRegister = hasAlarm()
+      ? RTC_CommitTimeDateAndAlarm(RTC, mTimeReg, mCalReg, mRtc12HrsMode,
+          mRtc12HrsMode ? mTimeAlarmReg12 : mTimeAlarmReg24, mCalAlarmReg)
+      : RTC_CommitTimeAndDate(RTC, mTimeReg, mCalReg, mRtc12HrsMode);
   // In order to detect whether RTC carries daylight savings time or
   // standard time, 12-hrs mode of RTC is applied, when RTC carries
   // daylight savings time.
@@ -556,20 +680,40 @@ void RtcSetTimeCache::writeToRtc() const {
     Serial.println(", set to 24-hrs mode.");
   }
 #endif
+  return not (rtcValidEntryRegister & (1 << RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED));
 }
 
-unsigned RtcTime::readFromRtc() {
-  const unsigned validEntryRegister = RTC_GetTimeAndDate(RTC, nullptr, &mHour, &mMinute, &mSecond, &mYear, &mMonth, &mDayOfMonth,
-      &mDayOfWeekDay, &mRtc12hrsMode);
+void RtcTime::set(const RtcSnapshot& snapshot) {
+  mRtc12hrsMode = snapshot.rtc12hrsMode();
+  RTC_TimeRegToTime(snapshot.timeReg(), nullptr, &mHour, &mMinute, &mSecond, mRtc12hrsMode);
+  RTC_CalRegToDate(snapshot.calReg(), &mYear, &mMonth, &mDayOfMonth, &mDayOfWeekDay);
   mState = FROM_RTC;
-  return validEntryRegister;
 }
 
-unsigned RtcTime::readFromRtc_() {
-  const unsigned validEntryRegister = RTC_GetTimeAndDate(RTC, nullptr, &mHour, &mMinute, &mSecond, &mYear, &mMonth, &mDayOfMonth,
-      &mDayOfWeekDay, &mRtc12hrsMode);
-  mState = FROM_RTC;
-  return validEntryRegister;
+void RtcTime::setTimeOfDay(const uint32_t timeReg, const uint8_t rtc12hrsMode) {
+  mRtc12hrsMode = rtc12hrsMode;
+  RTC_TimeRegToTime(timeReg, nullptr, &mHour, &mMinute, &mSecond, mRtc12hrsMode);
+}
+
+void RtcTime::setDate(const uint32_t calReg) {
+  RTC_CalRegToDate(calReg, &mYear, &mMonth, &mDayOfMonth, &mDayOfWeekDay);
+}
+
+unsigned RtcTime::readFromRtc() {
+  RtcSnapshot snapshot;
+  if(snapshot.readFromRtc() == RTC_READ_UNSTABLE) {
+    return 1 << RTC_RET_BITPOS_READ_UNSTABLE;
+  }
+  set(snapshot);
+  return RtcSnapshot::validEntryRegister();
+}
+
+void RtcTime::readFromRtc_() {
+  RtcSnapshot snapshot;
+  if(snapshot.readFromRtc() == RTC_READ_UNSTABLE) {
+    return;
+  }
+  set(snapshot);
 #if RTC_DEBUG_HOUR_MODE
   Serial.print(__FUNCTION__);
   if(mRtc12hrsMode) {
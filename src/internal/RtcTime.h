@@ -35,6 +35,8 @@ class Stream;
 
 namespace Sam3XA {
 
+class RtcSnapshot;
+
 /**
  * A class to read RTC registers from, and write RTC registers
  * to the Sam3X RTC.
@@ -51,12 +53,33 @@ class RtcTime {
   /**
    * Read the RTC time and date and store the result in this object.
    * Convert the result to 24 hrs mode if RTC runs in 12-hrs mode.
-   *
-   * @return validEntryRegister of RTC
+   * The RTC Valid Entry Register is not read. The re-reads are bounded
+   * by RTC_READ_RETRY_LIMIT. This object is left unchanged, if the
+   * registers did not get stable.
+   */
+  void readFromRtc_();
+
+  /**
+   * Set this RtcTime to other shifted by sec seconds. Shifts of less
+   * than a day are performed by carry propagation over the time and
+   * date fields. Larger shifts take the path via the unix time stamp.
+   */
+  void setShifted(const RtcTime& other, const std::time_t sec);
+
+  /**
+   * Add sec seconds to the time and date fields and propagate the
+   * carry across day, month and year. |sec| must be less than a day.
    */
-  unsigned readFromRtc_();
+  void addSecondsWithinDay(const int32_t sec);
 
 public:
+  /**
+   * Seconds by which the RTC daylight savings check recognizes the
+   * begin of the daylight savings period early, because the RTC is
+   * updated at the next second.
+   */
+  static constexpr int32_t DST_BEGIN_LEAD_TIME = 1;
+
   inline uint8_t hour() const {return mHour;}
   inline uint8_t minute() const {return mMinute;}
   inline uint8_t second() const {return mSecond;}
@@ -81,10 +104,40 @@ public:
   /** Get a tm struct from this RtcTime. */
   void get(std::tm &time) const;
 
+  /** Get tm_hour, tm_min, tm_sec and tm_isdst only. */
+  void getTimeOfDay(std::tm &time) const;
+
+  /** Get tm_year, tm_mon, tm_mday, tm_wday and tm_yday only. */
+  void getDate(std::tm &time) const;
+
   /** Set RtcTime from a tm struct. */
   void set(const std::tm &time);
   void set(const std::time_t timestamp, const uint8_t isdst);
 
+  /**
+   * Set RtcTime from a UTC time stamp. The local standard time is
+   * calculated from the time zone offset. The daylight savings
+   * period is determined from that in the same way as the RTC
+   * daylight savings check does it. No newlib time functions are
+   * involved. Prerequisite: time zone is set by RtcDueRcf::tzset().
+   */
+  void setUtc(const std::time_t utcTimestamp);
+
+  /** Set RtcTime from RTC register contents. */
+  void set(const RtcSnapshot& snapshot);
+
+  /**
+   * Set the time of day fields and the hour mode from the RTC_TIMR
+   * register contents. The date fields and the state are unchanged.
+   */
+  void setTimeOfDay(const uint32_t timeReg, const uint8_t rtc12hrsMode);
+
+  /**
+   * Set the date fields from the RTC_CALR register contents. The time
+   * of day fields and the state are unchanged.
+   */
+  void setDate(const uint32_t calReg);
+
   /** Just needed for test */
   void set12HrsMode(bool mode = false) {mRtc12hrsMode = mode;}
 
@@ -104,8 +157,11 @@ public:
   /**
    * Read the RTC time and date and store the result in this object.
    * Convert the result to 24 hrs mode if RTC runs in 12-hrs mode.
+   * The re-reads are bounded by RTC_READ_RETRY_LIMIT.
    *
-   * @return validEntryRegister of RTC
+   * @return validEntryRegister of RTC. The alarm enabled flags are
+   *  not provided. Bit[RTC_RET_BITPOS_READ_UNSTABLE] only, if the
+   *  registers did not get stable. This object is left unchanged then.
    */
   unsigned readFromRtc();
 
@@ -114,14 +170,21 @@ public:
    * Let the RTC run in 12-hrs mode during the daylight savings
    * period. Let it run in 24-hrs mode outside of the daylight
    * savings period (as per software design decision).
+   *
+   * @param dstBeginLeadTime Seconds by which the begin of the daylight
+   *    savings period is recognized early. The RTC daylight savings
+   *    check uses DST_BEGIN_LEAD_TIME.
    */
-  static int isdst(Sam3XA::RtcTime& stdTime, Sam3XA::RtcTime& dstTime);
+  static int isdst(Sam3XA::RtcTime& stdTime, Sam3XA::RtcTime& dstTime,
+      const int32_t dstBeginLeadTime = DST_BEGIN_LEAD_TIME);
 
   /**
    * Check whether the Rtc hour mode must be changed due to daylight
    * savings transition.
+   *
+   * @param rtcTime The time that has been read from the RTC.
    */
-  bool isDstRtcRequest();
+  bool isDstRtcRequest(const RtcTime& rtcTime);
 
   /** Query if this RtcTime is valid */
   uint8_t isValid()   const {return mState != INVALID;}
@@ -134,7 +197,7 @@ public:
    *  Either stdTime must be valid or dstTime must be valid.
    */
   static const Sam3XA::RtcTime* getDstBeginCompareTime(Sam3XA::RtcTime& stdTime, const Sam3XA::RtcTime& dstTime,
-      const int32_t dstTimeShift, Sam3XA::RtcTime& buffer);
+      const int32_t dstTimeShift, const int32_t dstBeginLeadTime, Sam3XA::RtcTime& buffer);
 
   /** Calculate the RtcTime that is required for comparison against
    *  end of daylight savings transition.
@@ -143,6 +206,16 @@ public:
   static const Sam3XA::RtcTime* getDstEndCompareTime(const Sam3XA::RtcTime& stdTime, Sam3XA::RtcTime& dstTime,
       const int32_t dstTimeShift);
 
+  /**
+   * Time and date packed into an integer, that preserves the
+   * chronological order. Other than toTimeStamp(), there are
+   * neither multiplications nor divisions. m12hoursMode is ignored.
+   */
+  uint64_t chronoKey() const {
+    return (static_cast<uint64_t>((mYear << 9) | (mMonth << 5) | mDayOfMonth) << 17)
+        | (mHour << 12) | (mMinute << 6) | mSecond;
+  }
+
   /**
    * Convert this RtcTime to a unix timestamp. m12hoursMode which signals
    * daylight savings time period is ignored.
@@ -182,14 +255,52 @@ class RtcSetTimeCache {
   //  1: RTC runs in 12-hrs mode.
   uint32_t mRtc12HrsMode;
 
+  // Alarm to be written along with the time. Both hour modes, because
+  // the hour mode of the time may change after the alarm has been set.
+  uint32_t mTimeAlarmReg24;
+  uint32_t mTimeAlarmReg12;
+  uint32_t mCalAlarmReg;
+
 public:
   RtcSetTimeCache();
 
   bool isValid() const;
 
+  /**
+   * Set from a time. Values the RTC would not accept are rejected and
+   * leave this cache unchanged.
+   *
+   * @return true if successful.
+   */
   bool set(const RtcTime &rtcTime);
   bool set(const std::tm &tm);
 
+  /**
+   * Set from precalculated register contents, e.g. the ones provided by
+   * RtcRegs. Contents the RTC would not accept are rejected and leave
+   * this cache unchanged.
+   *
+   * @return true if successful.
+   */
+  bool set(const uint32_t timeReg, const uint32_t calReg, const uint32_t rtc12HrsMode);
+
+  /**
+   * Set the alarm that is written along with the time. Contents the RTC
+   * would not accept are rejected and leave this cache unchanged.
+   *
+   * @return true if successful.
+   */
+  bool setAlarm(const uint32_t timeAlarmReg24, const uint32_t timeAlarmReg12, const uint32_t calAlarmReg);
+
+  /** @return true, if an alarm is written along with the time. */
+  bool hasAlarm() const;
+
+  /**
+   * Take over the alarm of the other cache, unless this cache has an
+   * alarm of its own.
+   */
+  void inheritAlarm(const RtcSetTimeCache& other);
+
   /**
    * Convert to RtcTime format.
    */
@@ -198,9 +309,14 @@ public:
   /**
    * Write the time and date of this object to the RTC. If RTC runs
    * in 12-hrs mode, RTC registers will be set with a 12-hrs mode
-   * time format. I.e. hours mode of the RTC isn't changed.
+   * time format. I.e. hours mode of the RTC isn't changed. The alarm
+   * is written within the same update, if set.
+   * To be called, after the RTC has acknowledged the update request.
+   * Does not wait for the acknowledge.
+   *
+   * @return true, if the RTC had acknowledged the update request.
    */
-  void writeToRtc() const;
+  bool writeToRtc() const;
 };
 
 } // namespace Sam3XA_Rtc
@@ -0,0 +1,119 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_INTERNAL_RTCTIMESEQLOCK_H_
+#define RTCDUERCF_SRC_INTERNAL_RTCTIMESEQLOCK_H_
+
+#include <stdint.h>
+#include <atomic>
+#include "RtcTime.h"
+
+namespace Sam3XA {
+
+/**
+ * A RAM copy of the RTC time that is published once a second by the RTC
+ * second interrupt and protected by a sequence lock. Readers never wait
+ * for the writer and don't access the RTC peripheral.
+ *
+ * The sequence number is odd while the writer is updating the copy. A
+ * thread level reader that got interrupted by the writer retries. A
+ * reader that interrupted the writer (an ISR with a higher priority than
+ * the RTC interrupt) can't wait for the writer, so it fails and must fall
+ * back to reading the RTC registers.
+ */
+class RtcTimeSeqlock {
+public:
+  /**
+   * The copy is considered outdated, when it has not been published
+   * for this time. This happens when the RTC second interrupt is
+   * disabled or blocked.
+   */
+  static constexpr uint32_t MAX_AGE_US = 1100000;
+
+  /**
+   * Publish a time. To be called by the writer only.
+   *
+   * @param rtcTime The time read from the RTC. Pass an invalid
+   *    RtcTime to let readers fail until the next publish.
+   * @param secondMicros micros() latched at the begin of the RTC second.
+   */
+  void publish(const RtcTime& rtcTime, const uint32_t secondMicros) {
+    mSequence = mSequence + 1;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    mTime = rtcTime;
+    mSecondMicros = secondMicros;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    mSequence = mSequence + 1;
+  }
+
+  /** Let readers fail until the next publish. To be called by the writer only. */
+  void invalidate() {
+    publish(RtcTime(), 0);
+  }
+
+  /**
+   * Read the published time.
+   *
+   * @param rtcTime Receives the time.
+   * @param now Current micros().
+   *
+   * @return true, if a valid, up to date time has been read.
+   */
+  bool read(RtcTime& rtcTime, const uint32_t now) const {
+    uint32_t secondMicros;
+    return read(rtcTime, secondMicros, now);
+  }
+
+  /**
+   * Read the published time along with the micros() that have been
+   * latched at the begin of its second.
+   */
+  bool read(RtcTime& rtcTime, uint32_t& secondMicros, const uint32_t now) const {
+    for(;;) {
+      const uint32_t sequence = mSequence;
+      if(sequence & 1) {
+        // Interrupted the writer.
+        return false;
+      }
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      rtcTime = mTime;
+      secondMicros = mSecondMicros;
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+      if(sequence == mSequence) {
+        return rtcTime.isValid() && (now - secondMicros) <= MAX_AGE_US;
+      }
+    }
+  }
+
+private:
+  volatile uint32_t mSequence = 0;
+  RtcTime mTime;
+  uint32_t mSecondMicros = 0;
+};
+
+} // namespace Sam3XA
+
+#endif /* RTCDUERCF_SRC_INTERNAL_RTCTIMESEQLOCK_H_ */
@@ -0,0 +1,44 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "../RtcDueRcf_Regs.h"
+#include "RtcTimeZone.h"
+
+namespace Sam3XA {
+
+RtcDueRcf_TimeZone RtcTimeZone::mRules = RtcDueRcf_TimeZone::utc();
+
+int32_t RtcTimeZone::transitionDay(const RtcDueRcf_TzRule& tzrule, const uint16_t year) {
+  using namespace RtcRegsConstexpr;
+  // Day of week of the 1st within the month. 0=SUN ..6=SAT
+  const int wdayOfFirst = rtcDayOfWeek(year, tzrule.m, 1) - 1;
+  int mday = 1 + (tzrule.d - wdayOfFirst + 7) % 7 + 7 * (tzrule.n - 1);
+  while(mday > static_cast<int>(daysInMonth(year, tzrule.m))) {
+    // n = 5 means the last occurrence within the month.
+    mday -= 7;
+  }
+  return daysFromCivil(year, tzrule.m, mday);
+}
+
+} // namespace Sam3XA
@@ -0,0 +1,72 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_INTERNAL_RTCTIMEZONE_H_
+#define RTCDUERCF_SRC_INTERNAL_RTCTIMEZONE_H_
+
+#include "../RtcDueRcf_TimeZone.h"
+
+namespace Sam3XA {
+
+/**
+ * The time zone rules, that the daylight savings logic and the UTC
+ * conversions work with. They are independent of newlib's time zone
+ * information.
+ */
+class RtcTimeZone {
+public:
+  static const RtcDueRcf_TimeZone& rules() {return mRules;}
+
+  /**
+   * Set the rules. The caller must ensure that the RTC interrupt does
+   * not read them meanwhile.
+   */
+  static void set(const RtcDueRcf_TimeZone& rules) {mRules = rules;}
+
+  /**
+   * Seconds to be added to the local time to get the UTC time.
+   *
+   * @param isdst The local time is a daylight savings time.
+   */
+  static int32_t localToUtcOffset(const uint32_t isdst) {
+    return mRules.rule[(isdst && mRules.daylight) ? 1 : 0].offset;
+  }
+
+  /**
+   * Day of a transition rule within year. Like the RTC daylight savings
+   * check does it, all rules are treated as M rules.
+   *
+   * @return Days since 1st of January 1970.
+   */
+  static int32_t transitionDay(const RtcDueRcf_TzRule& tzrule, const uint16_t year);
+
+private:
+  static RtcDueRcf_TimeZone mRules;
+};
+
+} // namespace Sam3XA
+
+#endif /* RTCDUERCF_SRC_INTERNAL_RTCTIMEZONE_H_ */
@@ -0,0 +1,84 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#include "RtcTimeZone.h"
+#include "RtcZoneView.h"
+
+namespace Sam3XA {
+
+void RtcZoneView::set(const RtcDueRcf_TimeZone& rules) {
+  mRules = rules;
+  mTable = nullptr;
+  mValidFrom = 0;
+  mValidUntil = 0;
+}
+
+void RtcZoneView::set(const RtcDueRcf_TzTable& table) {
+  mRules = RtcDueRcf_TimeZone::utc();
+  mTable = &table;
+  mValidFrom = 0;
+  mValidUntil = 0;
+}
+
+void RtcZoneView::update(const std::time_t utcTimestamp) {
+  if(mTable) {
+    const RtcDueRcf_TzTable::Type& type = mTable->lookup(utcTimestamp, mValidFrom, mValidUntil);
+    mOffset = type.offset;
+    mIsdst = type.isdst;
+    return;
+  }
+
+  mValidFrom = RtcDueRcf_TzTable::TIME_MIN;
+  mValidUntil = RtcDueRcf_TzTable::TIME_MAX;
+  mOffset = mRules.rule[0].offset;
+  mIsdst = 0;
+  if(not mRules.daylight) {
+    return;
+  }
+
+  RtcTime utcTime;
+  utcTime.set(utcTimestamp, 0);
+  // Rule 0 begins the daylight savings period in standard time, rule 1
+  // ends it in daylight savings time. The transitions of the adjacent
+  // years enclose utcTimestamp in both hemispheres.
+  for(int year = utcTime.year() - 1; year <= utcTime.year() + 1; year++) {
+    for(uint8_t i = 0; i < 2; i++) {
+      const RtcDueRcf_TzRule& tzrule = mRules.rule[i];
+      const std::time_t transition = static_cast<std::time_t>(RtcTimeZone::transitionDay(tzrule, year))
+          * 24 * 60 * 60 + tzrule.s + tzrule.offset;
+      if(transition <= utcTimestamp) {
+        if(transition >= mValidFrom) {
+          mValidFrom = transition;
+          // The offset that is valid after the transition.
+          mIsdst = i == 0;
+          mOffset = mRules.rule[mIsdst].offset;
+        }
+      } else if(transition < mValidUntil) {
+        mValidUntil = transition;
+      }
+    }
+  }
+}
+
+} // namespace Sam3XA
@@ -0,0 +1,84 @@
+/*
+  RtcDueRcf - Arduino libary for Arduino Due - builtin RTC Copyright (c)
+  2024 Wolfgang Schmieder.  All right reserved.
+
+  Contributors:
+  - Wolfgang Schmieder
+
+  Project home: https://github.com/dac1e/RtcDueRcf
+
+  This library is free software; you can redistribute it and/or modify it
+  the terms of the GNU Lesser General Public License as under published
+  by the Free Software Foundation; either version 3.0 of the License,
+  or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+*/
+
+#pragma once
+
+#ifndef RTCDUERCF_SRC_INTERNAL_RTCZONEVIEW_H_
+#define RTCDUERCF_SRC_INTERNAL_RTCZONEVIEW_H_
+
+#include <stdint.h>
+#include <ctime>
+#include "../RtcDueRcf_TimeZone.h"
+#include "../RtcDueRcf_TzTable.h"
+#include "RtcTime.h"
+
+namespace Sam3XA {
+
+/**
+ * A time zone, that UTC time stamps can be converted to independently
+ * of the time zone that the RTC runs with. It keeps its own rules and
+ * the UTC interval between two daylight savings transitions, that its
+ * offset has been calculated for. While a time stamp is within that
+ * interval, the conversion does not evaluate the rules. Instead of the
+ * rules, a compiled time zone history can be used.
+ */
+class RtcZoneView {
+public:
+  RtcZoneView() : mRules(RtcDueRcf_TimeZone::utc()), mTable(nullptr), mValidFrom(0), mValidUntil(0),
+      mOffset(0), mIsdst(0) {}
+
+  /** Set the rules and drop the cached interval. */
+  void set(const RtcDueRcf_TimeZone& rules);
+
+  /** Set the time zone history and drop the cached interval. */
+  void set(const RtcDueRcf_TzTable& table);
+
+  const RtcDueRcf_TimeZone& rules() const {return mRules;}
+
+  /**
+   * Convert a UTC time stamp to the local time of this zone. The local
+   * time has the 12-hrs mode set within the daylight savings period.
+   */
+  void toLocal(const std::time_t utcTimestamp, RtcTime& localTime) {
+    if(utcTimestamp < mValidFrom || utcTimestamp >= mValidUntil) {
+      update(utcTimestamp);
+    }
+    localTime.set(utcTimestamp - mOffset, mIsdst);
+  }
+
+private:
+  /** Calculate the interval between the transitions around utcTimestamp. */
+  void update(const std::time_t utcTimestamp);
+
+  RtcDueRcf_TimeZone mRules;
+  const RtcDueRcf_TzTable* mTable;
+  std::time_t mValidFrom;
+  std::time_t mValidUntil;
+  int32_t mOffset;
+  uint8_t mIsdst;
+};
+
+} // namespace Sam3XA
+
+#endif /* RTCDUERCF_SRC_INTERNAL_RTCZONEVIEW_H_ */
@@ -46,40 +46,131 @@
 #define RTC_TIMALR_MINEN_BITPOS  15
 #define RTC_TIMALR_SECEN_BITPOS   7
 
+/*
+ * 1: Use the lookup table bcd codec for the RTC_TIMR and RTC_CALR
+ *    conversion functions.
+ * 0: Use the original arithmetic bcd codec with divisions and
+ *    12-hrs mode branches.
+ */
+#ifndef RTC_BCD_CODEC_LOOKUP_TABLE
+  #define RTC_BCD_CODEC_LOOKUP_TABLE 1
+#endif
+
 /*----------------------------------------------------------------------------
  *        Internal functions
  *----------------------------------------------------------------------------*/
 
-static unsigned getCalAlrEnRetFlags(const Rtc* const pRtc) {
+static unsigned calAlrEnRetFlags(const uint32_t calAlr) {
   const unsigned result =
     // Place alarm enable bits in bits[4..9]
-      (pRtc->RTC_CALALR & RTC_CALALR_MTHEN)  >> (RTC_CALALR_MTHEN_BITPOS  - RTC_RET_BITPOS_CALALR_MTHEN )
-    | (pRtc->RTC_CALALR & RTC_CALALR_DATEEN) >> (RTC_CALALR_DATEEN_BITPOS - RTC_RET_BITPOS_CALALR_DATEEN)
+      (calAlr & RTC_CALALR_MTHEN)  >> (RTC_CALALR_MTHEN_BITPOS  - RTC_RET_BITPOS_CALALR_MTHEN )
+    | (calAlr & RTC_CALALR_DATEEN) >> (RTC_CALALR_DATEEN_BITPOS - RTC_RET_BITPOS_CALALR_DATEEN)
   ;
   return result;
 }
 
-static unsigned getTimeAlrEnRetFlags(const Rtc* const pRtc) {
+static unsigned getCalAlrEnRetFlags(const Rtc* const pRtc) {
+  // Single read of the peripheral register.
+  return calAlrEnRetFlags(pRtc->RTC_CALALR);
+}
+
+static unsigned timeAlrEnRetFlags(const uint32_t timAlr) {
   const unsigned result =
-      (pRtc->RTC_TIMALR & RTC_TIMALR_HOUREN) >> (RTC_TIMALR_HOUREN_BITPOS - RTC_RET_BITPOS_TIMALR_HOUREN)
-    | (pRtc->RTC_TIMALR & RTC_TIMALR_MINEN)  >> (RTC_TIMALR_MINEN_BITPOS  - RTC_RET_BITPOS_TIMALR_MINEN )
-    | (pRtc->RTC_TIMALR & RTC_TIMALR_SECEN)  >> (RTC_TIMALR_SECEN_BITPOS  - RTC_RET_BITPOS_TIMALR_SECEN )
+      (timAlr & RTC_TIMALR_HOUREN) >> (RTC_TIMALR_HOUREN_BITPOS - RTC_RET_BITPOS_TIMALR_HOUREN)
+    | (timAlr & RTC_TIMALR_MINEN)  >> (RTC_TIMALR_MINEN_BITPOS  - RTC_RET_BITPOS_TIMALR_MINEN )
+    | (timAlr & RTC_TIMALR_SECEN)  >> (RTC_TIMALR_SECEN_BITPOS  - RTC_RET_BITPOS_TIMALR_SECEN )
   ;
   return result;
 }
 
-/**
- * \brief Convert the RTC_TIMR bcd format to hour
+static unsigned getTimeAlrEnRetFlags(const Rtc* const pRtc) {
+  // Single read of the peripheral register.
+  return timeAlrEnRetFlags(pRtc->RTC_TIMALR);
+}
+
+/*----------------------------------------------------------------------------
+ *        SWAR (SIMD within a register) validation
+ *----------------------------------------------------------------------------*/
+
+/* The bcd fields of RTC_TIMR: hour, minute, second. */
+#define RTC_TIMR_FIELDS       0x003F7F7Fu
+/* The bcd fields of RTC_CALR: date, month, year, century. Not the week. */
+#define RTC_CALR_BCD_FIELDS   0x3F1FFF7Fu
+/* The fields of RTC_CALR that are range checked: date, month, century. */
+#define RTC_CALR_RANGE_FIELDS 0x3F1F007Fu
+#define RTC_CALR_FIELDS       (RTC_CALR_BCD_FIELDS | RTC_CALR_DAY_Msk)
+
+#define RTC_SWAR_NIBBLE_LO    0x0F0F0F0Fu
+#define RTC_SWAR_NIBBLE_CARRY 0x10101010u
+#define RTC_SWAR_BYTE_MSB     0x80808080u
+
+/*
+ * Per byte range [lo..hi] constants for isWithinByteRanges(). Byte 3..0:
+ * Each byte of the LO constant is 0x80 - lo, each byte of the HI constant
+ * is 0x7F - hi.
  *
- * \param timeReg     The contents of the RTC_TIMR register.
- * \param pucAMPM    If not null, the variable will be set to 1 if time is PM. The variable will
- *                   be set to 0 if time is AM.
- * \param pucHour    If not null, current hour is stored in this variable. The hour representation
- *                   is as follows:
- *                     In case pucAMPM is not null, the hour will be in the interval of [1 .. 12].
- *                     In case pucAMPM is null, the hour will be in the interval of [0 .. 23].
+ * RTC_TIMR: 0, hour, minute, second.
  */
-void RTC_TimeRegisterToHour(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour, const uint32_t timeReg12HrsMode )
+#define RTC_TIMR_24_LO        0x80808080u /* [0,  0,  0,  0] */
+#define RTC_TIMR_24_HI        0x7F5C2626u /* [0, 23, 59, 59] */
+#define RTC_TIMR_12_LO        0x807F8080u /* [0,  1,  0,  0] */
+#define RTC_TIMR_12_HI        0x7F6D2626u /* [0, 12, 59, 59] */
+/* RTC_CALR with the week moved to byte 1: date, month, week, century. */
+#define RTC_CALR_LO           0x7F7F7F67u /* [ 1,  1, 1, 19] */
+#define RTC_CALR_HI           0x4E6D785Fu /* [31, 12, 7, 20] */
+/* RTC_CALALR: date, month. */
+#define RTC_CALALR_LO         0x7F7F8080u /* [ 1,  1, 0, 0] */
+#define RTC_CALALR_HI         0x4E6D7F7Fu /* [31, 12, 0, 0] */
+
+/*
+ * Returns non zero, if any nibble of bcd is greater than 9. Adding 6 to
+ * a nibble greater than 9 carries into the next bit. The nibbles are
+ * spread to separate bytes, so the carries can't interfere.
+ */
+static inline uint32_t hasInvalidBcdNibble(const uint32_t bcd)
+{
+    return (((bcd & RTC_SWAR_NIBBLE_LO) + 0x06060606u)
+          | (((bcd >> 4) & RTC_SWAR_NIBBLE_LO) + 0x06060606u)) & RTC_SWAR_NIBBLE_CARRY;
+}
+
+/*
+ * Returns non zero, if every byte of bytes is within its range. The bytes
+ * must be lower than 0x80. Then the additions can't carry into the next
+ * byte and the most significant bit of each sum is the compare result.
+ */
+static inline uint32_t isWithinByteRanges(const uint32_t bytes, const uint32_t lo, const uint32_t hi)
+{
+    return ((bytes + lo) & ~(bytes + hi) & RTC_SWAR_BYTE_MSB) == RTC_SWAR_BYTE_MSB;
+}
+
+/* Number of days of the months in bcd, index is the bcd month [0x01..0x12]. */
+static const uint8_t BCD_DAYS_IN_MONTH[0x13] = {
+    0x00, 0x31, 0x29, 0x31, 0x30, 0x31, 0x30, 0x31, 0x31, 0x30,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x31, 0x30, 0x31,
+};
+
+/*
+ * Days per month check for a range checked month and date. February 29th
+ * passes for leap years only, if year is given. Pass the bcd year 0x00 of
+ * century 0x20 for a leap year.
+ */
+static inline uint32_t isDateWithinMonth(const uint32_t bcdDate, const uint32_t bcdMonth,
+    const uint32_t bcdYear, const uint32_t bcdCent)
+{
+    /* 10 * tens + ones is divisible by 4, if 2 * tens + ones is. Only 1900
+     * and 2000 are century years within the RTC range. */
+    const uint32_t leapYear = ((2 * (bcdYear >> 4) + (bcdYear & 0x0F)) & 3) == 0
+        && (bcdYear != 0x00 || bcdCent == 0x20);
+    return bcdDate <= BCD_DAYS_IN_MONTH[bcdMonth] - (bcdMonth == 0x02 && !leapYear);
+}
+
+/*----------------------------------------------------------------------------
+ *        Arithmetic bcd codec (original implementation)
+ *----------------------------------------------------------------------------*/
+
+#if !RTC_BCD_CODEC_LOOKUP_TABLE || defined(TEST_RtcDueRcf)
+
+static void timeRegisterToHourArith(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour, const uint32_t timeReg12HrsMode )
 {
     *pucHour = ((timeReg & 0x00300000) >> 20) * 10 + ((timeReg & 0x000F0000) >> 16);
 
@@ -129,22 +220,18 @@ void RTC_TimeRegisterToHour(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* c
     }
 }
 
-/*----------------------------------------------------------------------------
- *        Exported functions
- *----------------------------------------------------------------------------*/
-
-extern void RTC_TimeRegToTime(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour,
+static void timeRegToTimeArith(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour,
     uint8_t* const pucMinute, uint8_t* const pucSecond, const uint32_t timeReg12HrsMode )
 {
     /* Hour */
     if ( pucHour )
     {
-      RTC_TimeRegisterToHour(timeReg, pucAMPM, pucHour, timeReg12HrsMode);
+      timeRegisterToHourArith(timeReg, pucAMPM, pucHour, timeReg12HrsMode);
     }
     else if( pucAMPM )
     {
       uint8_t hour;
-      RTC_TimeRegisterToHour(timeReg, pucAMPM, &hour, timeReg12HrsMode);
+      timeRegisterToHourArith(timeReg, pucAMPM, &hour, timeReg12HrsMode);
     }
 
     /* Minute */
@@ -162,7 +249,7 @@ extern void RTC_TimeRegToTime(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t*
     }
 }
 
-extern void RTC_CalRegToDate(uint32_t calReg, uint16_t* const pwYear, uint8_t* const pucMonth,
+static void calRegToDateArith(uint32_t calReg, uint16_t* const pwYear, uint8_t* const pucMonth,
     uint8_t* const pucDay, uint8_t* const pucWeek )
 {
     /* Retrieve year */
@@ -193,7 +280,7 @@ extern void RTC_CalRegToDate(uint32_t calReg, uint16_t* const pwYear, uint8_t* c
     }
 }
 
-extern uint32_t RTC_TimeToTimeReg(uint8_t ucHour, const uint8_t ucMinute, const uint8_t ucSecond, const uint32_t timeReg12HrsMode)
+static uint32_t timeToTimeRegArith(uint8_t ucHour, const uint8_t ucMinute, const uint8_t ucSecond, const uint32_t timeReg12HrsMode)
 {
     uint32_t dwAmPm = 0 ;
 
@@ -233,7 +320,7 @@ extern uint32_t RTC_TimeToTimeReg(uint8_t ucHour, const uint8_t ucMinute, const
     return dwAmPm | ucSec_bcd | (ucMin_bcd << 8) | (ucHour_bcd<<16) ;
 }
 
-extern uint32_t RTC_DateToCalReg(const uint16_t wYear, const uint8_t ucMonth, const uint8_t ucDay, const uint8_t ucWeek )
+static uint32_t dateToCalRegArith(const uint16_t wYear, const uint8_t ucMonth, const uint8_t ucDay, const uint8_t ucWeek )
 {
     uint8_t ucCent_bcd ;
     uint8_t ucYear_bcd ;
@@ -266,51 +353,457 @@ extern uint32_t RTC_DateToCalReg(const uint16_t wYear, const uint8_t ucMonth, co
             (ucDay_bcd << 24);
 }
 
+#endif // !RTC_BCD_CODEC_LOOKUP_TABLE || defined(TEST_RtcDueRcf)
+
+/*----------------------------------------------------------------------------
+ *        Lookup table bcd codec
+ *----------------------------------------------------------------------------*/
+
+#if RTC_BCD_CODEC_LOOKUP_TABLE || defined(TEST_RtcDueRcf)
+
+/* Binary [0..99] to packed bcd. */
+static const uint8_t BIN_TO_BCD[100] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+  0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+  0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+  0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+  0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+  0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+};
+
+/*
+ * 24-hrs representation [0..23] to the hour byte of RTC_TIMR (bits[16..23]).
+ * Index 0: RTC_TIMR in 24-hrs mode.
+ * Index 1: RTC_TIMR in 12-hrs mode, including the AMPM bit (bit 22 = 0x40).
+ */
+static const uint8_t HOUR_TO_TIMR_HOUR[2][24] = {
+  {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+  },
+  {
+    0x12, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x52, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x50, 0x51,
+  },
+};
+
+/*
+ * Packed bcd byte to binary. Each tens digit contributes 16 instead of 10,
+ * hence subtract 6 per tens digit. This needs no table (a table would need
+ * 0x9A entries) and no branch.
+ */
+static inline uint32_t bcdToBin(const uint32_t bcd)
+{
+    return bcd - 6 * (bcd >> 4);
+}
+
+/*
+ * Branch free: Returns 1 if hour [0..23] is PM, 0 otherwise.
+ */
+static inline uint32_t isPm(const uint32_t hour)
+{
+    return (hour + 4) >> 4;
+}
+
+static void timeRegisterToHourLut(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour, const uint32_t timeReg12HrsMode )
+{
+    const uint32_t mode = (timeReg12HrsMode != 0);
+    const uint32_t hour = bcdToBin((timeReg >> 16) & RTC_HOUR_BIT_LEN_MASK);
+    const uint32_t pm = (timeReg >> 22) & mode;
+
+    // 12-hrs mode: 12AM -> 0, 12PM -> 12, 1PM..11PM -> 13..23.
+    const uint32_t hour24 = hour - 12 * (mode & isPm(hour)) + 12 * pm;
+
+    if ( pucAMPM )
+    {
+        const uint32_t pm24 = isPm(hour24);
+        const uint32_t hour12 = hour24 - 12 * pm24;
+        *pucAMPM = pm24;
+        // Midnight and noon are 12 in 12-hrs representation.
+        *pucHour = hour12 + 12 * (1 - ((hour12 + 15) >> 4));
+    }
+    else
+    {
+        *pucHour = hour24;
+    }
+}
+
+static void timeRegToTimeLut(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour,
+    uint8_t* const pucMinute, uint8_t* const pucSecond, const uint32_t timeReg12HrsMode )
+{
+    /* Hour */
+    if ( pucHour )
+    {
+      timeRegisterToHourLut(timeReg, pucAMPM, pucHour, timeReg12HrsMode);
+    }
+    else if( pucAMPM )
+    {
+      uint8_t hour;
+      timeRegisterToHourLut(timeReg, pucAMPM, &hour, timeReg12HrsMode);
+    }
+
+    /* Minute */
+    if ( pucMinute )
+    {
+        *pucMinute = bcdToBin((timeReg >> 8) & RTC_MIN_BIT_LEN_MASK);
+    }
+
+    /* Second */
+    if ( pucSecond )
+    {
+        *pucSecond = bcdToBin(timeReg & RTC_SEC_BIT_LEN_MASK);
+    }
+}
+
+static void calRegToDateLut(uint32_t calReg, uint16_t* const pwYear, uint8_t* const pucMonth,
+    uint8_t* const pucDay, uint8_t* const pucWeek )
+{
+    /* Retrieve year */
+    if ( pwYear )
+    {
+        *pwYear = bcdToBin(calReg & RTC_CENT_BIT_LEN_MASK) * 100
+                + bcdToBin((calReg >> 8) & RTC_YEAR_BIT_LEN_MASK);
+    }
+
+    /* Retrieve month */
+    if ( pucMonth )
+    {
+        *pucMonth = bcdToBin((calReg >> 16) & RTC_MONTH_BIT_LEN_MASK);
+    }
+
+    /* Retrieve day */
+    if ( pucDay )
+    {
+        *pucDay = bcdToBin((calReg >> 24) & RTC_DATE_BIT_LEN_MASK);
+    }
+
+    /* Retrieve week */
+    if ( pucWeek )
+    {
+        *pucWeek = ((calReg >> 21) & RTC_WEEK_BIT_LEN_MASK);
+    }
+}
+
+static uint32_t timeToTimeRegLut(uint8_t ucHour, const uint8_t ucMinute, const uint8_t ucSecond, const uint32_t timeReg12HrsMode)
+{
+    /* value overflow */
+    if ( (ucHour >= 24) | (ucMinute >= 60) | (ucSecond >= 60) )
+    {
+        return RTC_INVALID_TIME_REG ;
+    }
+
+    return ((uint32_t)HOUR_TO_TIMR_HOUR[timeReg12HrsMode != 0][ucHour] << 16)
+         | ((uint32_t)BIN_TO_BCD[ucMinute] << 8)
+         | BIN_TO_BCD[ucSecond];
+}
+
+static uint32_t dateToCalRegLut(const uint16_t wYear, const uint8_t ucMonth, const uint8_t ucDay, const uint8_t ucWeek )
+{
+    /* value over flow */
+    if ( (wYear >= 8000) | (ucMonth > 12) | (ucDay > 31) | (ucWeek > 7) )
+    {
+        return RTC_INVALID_CAL_REG ;
+    }
+
+    const uint32_t cent = wYear / 100;
+
+    /* return date register value */
+    return  (uint32_t)BIN_TO_BCD[cent] |
+            ((uint32_t)BIN_TO_BCD[wYear - cent * 100] << 8) |
+            ((uint32_t)BIN_TO_BCD[ucMonth] << 16) |
+            ((uint32_t)ucWeek << 21) |
+            ((uint32_t)BIN_TO_BCD[ucDay] << 24);
+}
+
+#endif // RTC_BCD_CODEC_LOOKUP_TABLE || defined(TEST_RtcDueRcf)
+
+#ifdef TEST_RtcDueRcf
+
+const RtcBcdCodec RTC_BcdCodecArithmetic = {
+    timeToTimeRegArith, timeRegToTimeArith, dateToCalRegArith, calRegToDateArith
+};
+
+const RtcBcdCodec RTC_BcdCodecLookupTable = {
+    timeToTimeRegLut, timeRegToTimeLut, dateToCalRegLut, calRegToDateLut
+};
+
+#endif // TEST_RtcDueRcf
+
+#if RTC_BCD_CODEC_LOOKUP_TABLE
+  #define RTC_BCD_CODEC(function) function##Lut
+#else
+  #define RTC_BCD_CODEC(function) function##Arith
+#endif
+
+/**
+ * \brief Convert the RTC_TIMR bcd format to hour
+ *
+ * \param timeReg     The contents of the RTC_TIMR register.
+ * \param pucAMPM    If not null, the variable will be set to 1 if time is PM. The variable will
+ *                   be set to 0 if time is AM.
+ * \param pucHour    If not null, current hour is stored in this variable. The hour representation
+ *                   is as follows:
+ *                     In case pucAMPM is not null, the hour will be in the interval of [1 .. 12].
+ *                     In case pucAMPM is null, the hour will be in the interval of [0 .. 23].
+ */
+void RTC_TimeRegisterToHour(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour, const uint32_t timeReg12HrsMode )
+{
+    RTC_BCD_CODEC(timeRegisterToHour)(timeReg, pucAMPM, pucHour, timeReg12HrsMode);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+extern void RTC_TimeRegToTime(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour,
+    uint8_t* const pucMinute, uint8_t* const pucSecond, const uint32_t timeReg12HrsMode )
+{
+    RTC_BCD_CODEC(timeRegToTime)(timeReg, pucAMPM, pucHour, pucMinute, pucSecond, timeReg12HrsMode);
+}
+
+extern void RTC_CalRegToDate(uint32_t calReg, uint16_t* const pwYear, uint8_t* const pucMonth,
+    uint8_t* const pucDay, uint8_t* const pucWeek )
+{
+    RTC_BCD_CODEC(calRegToDate)(calReg, pwYear, pucMonth, pucDay, pucWeek);
+}
+
+extern uint32_t RTC_TimeToTimeReg(uint8_t ucHour, const uint8_t ucMinute, const uint8_t ucSecond, const uint32_t timeReg12HrsMode)
+{
+    return RTC_BCD_CODEC(timeToTimeReg)(ucHour, ucMinute, ucSecond, timeReg12HrsMode);
+}
+
+extern uint32_t RTC_DateToCalReg(const uint16_t wYear, const uint8_t ucMonth, const uint8_t ucDay, const uint8_t ucWeek )
+{
+    return RTC_BCD_CODEC(dateToCalReg)(wYear, ucMonth, ucDay, ucWeek);
+}
+
+extern unsigned RTC_IsValidTimeReg(const uint32_t timeReg, const uint32_t timeReg12HrsMode)
+{
+    const uint32_t fields = timeReg & RTC_TIMR_FIELDS;
+    const uint32_t otherBits = timeReg & ~(RTC_TIMR_FIELDS | (timeReg12HrsMode ? RTC_TIMR_AMPM : 0));
+    return !otherBits && !hasInvalidBcdNibble(fields)
+        && (timeReg12HrsMode ? isWithinByteRanges(fields, RTC_TIMR_12_LO, RTC_TIMR_12_HI)
+                             : isWithinByteRanges(fields, RTC_TIMR_24_LO, RTC_TIMR_24_HI));
+}
+
+extern unsigned RTC_IsValidCalReg(const uint32_t calReg)
+{
+    const uint32_t rangeFields = (calReg & RTC_CALR_RANGE_FIELDS)
+        | ((calReg & RTC_CALR_DAY_Msk) >> (RTC_CALR_DAY_Pos - 8));
+    return !(calReg & ~RTC_CALR_FIELDS) && !hasInvalidBcdNibble(calReg & RTC_CALR_BCD_FIELDS)
+        && isWithinByteRanges(rangeFields, RTC_CALR_LO, RTC_CALR_HI)
+        && isDateWithinMonth(calReg >> 24, (calReg >> 16) & RTC_MONTH_BIT_LEN_MASK,
+            (calReg >> 8) & RTC_YEAR_BIT_LEN_MASK, calReg & RTC_CENT_BIT_LEN_MASK);
+}
+
+extern unsigned RTC_IsValidTimeAlarmReg(const uint32_t timeAlarmReg, const uint32_t timeReg12HrsMode)
+{
+    return RTC_IsValidTimeReg(timeAlarmReg & ~(RTC_TIMALR_HOUREN | RTC_TIMALR_MINEN | RTC_TIMALR_SECEN),
+        timeReg12HrsMode);
+}
+
+extern unsigned RTC_IsValidCalAlarmReg(const uint32_t calAlarmReg)
+{
+    const uint32_t fields = calAlarmReg & ~(RTC_CALALR_MTHEN | RTC_CALALR_DATEEN);
+    return !(fields & ~(RTC_CALALR_MONTH_Msk | RTC_CALALR_DATE_Msk)) && !hasInvalidBcdNibble(fields)
+        && isWithinByteRanges(fields, RTC_CALALR_LO, RTC_CALALR_HI)
+        /* Without year, February 29th is valid. */
+        && isDateWithinMonth(fields >> 24, (fields >> 16) & RTC_MONTH_BIT_LEN_MASK, 0x00, 0x20);
+}
+
+/*
+ * Returns 0 if both alarm registers are valid. Otherwise the not valid
+ * flags in bit[2..3] as they would appear in RTC_VER, along with the
+ * alarm enabled flags of the rejected registers.
+ */
+static unsigned invalidAlarmRetFlags(const uint32_t timeAlarmReg, const uint32_t timeReg12HrsMode,
+    const uint32_t calAlarmReg)
+{
+    const unsigned invalid =
+        (RTC_IsValidTimeAlarmReg(timeAlarmReg, timeReg12HrsMode) ? 0 : RTC_VER_NVTIMALR)
+      | (RTC_IsValidCalAlarmReg(calAlarmReg) ? 0 : RTC_VER_NVCALALR);
+    return invalid ? invalid | timeAlrEnRetFlags(timeAlarmReg) | calAlrEnRetFlags(calAlarmReg) : 0;
+}
+
 extern unsigned RTC_GetTimeAndDate( Rtc* const pRtc, uint8_t* const pucAMPM,
     uint8_t* const pucHour, uint8_t* const pucMinute, uint8_t* const pucSecond,
     uint16_t* const pwYear, uint8_t* const pucMonth, uint8_t* const pucDay,
     uint8_t* const pucWeek, uint8_t* const pucRtc12HrsMode )
 {
-    uint32_t dwTime;
-    uint32_t dwDate;
+    RtcTimeSnapshot snapshot;
+    const unsigned retFlags = (pRtc->RTC_VER & (RTC_VER_NVCAL | RTC_VER_NVTIM | RTC_VER_NVCALALR | RTC_VER_NVTIMALR))
+        | getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc);
+
+    if(RTC_ReadTimeSnapshot(pRtc, &snapshot, RTC_READ_RETRY_LIMIT) == RTC_READ_UNSTABLE) {
+      return retFlags | (1 << RTC_RET_BITPOS_READ_UNSTABLE);
+    }
+
+    RTC_TimeRegToTime(snapshot.timr, pucAMPM, pucHour, pucMinute, pucSecond, snapshot.mr & RTC_MR_HRMOD );
+    RTC_CalRegToDate( snapshot.calr, pwYear, pucMonth, pucDay, pucWeek );
+
+    if(pucRtc12HrsMode) {
+      *pucRtc12HrsMode = snapshot.mr & RTC_MR_HRMOD;
+    }
+
+    return retFlags;
+}
+
+extern RtcTimeSnapshot RTC_GetTimeSnapshot( Rtc* const pRtc )
+{
+    RtcTimeSnapshot snapshot;
     // Re-read time and date as long as we get unstable time.
     do
     {
-      dwTime = pRtc->RTC_TIMR;
+      snapshot.timr = pRtc->RTC_TIMR;
       do
+      {
+        snapshot.calr = pRtc->RTC_CALR;
+      }
+      while ( snapshot.calr != pRtc->RTC_CALR );
+    }
+    while( snapshot.timr != pRtc->RTC_TIMR );
+
+    snapshot.mr = pRtc->RTC_MR;
+    return snapshot;
+}
+
+extern int RTC_ReadTimeSnapshot( Rtc* const pRtc, RtcTimeSnapshot* const pSnapshot,
+    const unsigned maxRetries )
+{
+    // Same register access order as RTC_GetTimeSnapshot(), but the
+    // re-reads of both loops share one budget.
+    unsigned retries = 0;
+    uint32_t dwTime;
+    uint32_t dwDate;
+    for(;;)
+    {
+      dwTime = pRtc->RTC_TIMR;
+      for(;;)
       {
         dwDate = pRtc->RTC_CALR;
+        if( dwDate == pRtc->RTC_CALR ) {
+          break;
+        }
+        if( retries++ == maxRetries ) {
+          return RTC_READ_UNSTABLE;
+        }
+      }
+      if( dwTime == pRtc->RTC_TIMR ) {
+        break;
+      }
+      if( retries++ == maxRetries ) {
+        return RTC_READ_UNSTABLE;
       }
-      while ( dwDate != pRtc->RTC_CALR );
     }
-    while( dwTime != pRtc->RTC_TIMR );
 
-    RTC_TimeRegToTime(dwTime, pucAMPM, pucHour, pucMinute, pucSecond, pRtc->RTC_MR & RTC_MR_HRMOD );
-    RTC_CalRegToDate( dwDate, pwYear, pucMonth, pucDay, pucWeek );
+    pSnapshot->timr = dwTime;
+    pSnapshot->calr = dwDate;
+    pSnapshot->mr = pRtc->RTC_MR;
+    return (int)retries;
+}
 
-    if(pucRtc12HrsMode) {
-      *pucRtc12HrsMode = pRtc->RTC_MR & RTC_MR_HRMOD;
+extern int RTC_ReadTimeReg( Rtc* const pRtc, uint32_t* const pTimeReg, uint32_t* const pRtc12HrsMode,
+    const unsigned maxRetries )
+{
+    unsigned retries = 0;
+    uint32_t dwMode;
+    uint32_t dwTime;
+    for(;;)
+    {
+      dwMode = pRtc->RTC_MR;
+      dwTime = pRtc->RTC_TIMR;
+      if( dwTime == pRtc->RTC_TIMR && dwMode == pRtc->RTC_MR ) {
+        break;
+      }
+      if( retries++ == maxRetries ) {
+        return RTC_READ_UNSTABLE;
+      }
     }
 
-    return (pRtc->RTC_VER & (RTC_VER_NVCAL | RTC_VER_NVTIM | RTC_VER_NVCALALR | RTC_VER_NVTIMALR))
-        | getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc);
+    *pTimeReg = dwTime;
+    *pRtc12HrsMode = dwMode & RTC_MR_HRMOD;
+    return (int)retries;
 }
 
-extern unsigned RTC_SetTimeAndDate(Rtc *const pRtc, const uint32_t timeReg, const uint32_t calReg,
-    const uint32_t rtc12hrsMode)
+extern int RTC_ReadCalReg( Rtc* const pRtc, uint32_t* const pCalReg, const unsigned maxRetries )
 {
-  const uint32_t current12HrsMode = (pRtc->RTC_MR & RTC_MR_HRMOD);
+    unsigned retries = 0;
+    uint32_t dwDate;
+    for(;;)
+    {
+      dwDate = pRtc->RTC_CALR;
+      if( dwDate == pRtc->RTC_CALR ) {
+        break;
+      }
+      if( retries++ == maxRetries ) {
+        return RTC_READ_UNSTABLE;
+      }
+    }
+
+    *pCalReg = dwDate;
+    return (int)retries;
+}
+
+extern unsigned RTC_GetValidEntry( Rtc* const pRtc )
+{
+    return pRtc->RTC_VER & (RTC_VER_NVCAL | RTC_VER_NVTIM | RTC_VER_NVCALALR | RTC_VER_NVTIMALR);
+}
+
+extern unsigned RTC_GetAlarmEnRetFlags( Rtc* const pRtc )
+{
+    return getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc);
+}
 
+extern void RTC_RequestTimeAndDateUpdate(Rtc *const pRtc)
+{
   /* Update calendar and time register together */
   pRtc->RTC_CR |= (RTC_CR_UPDTIM | RTC_CR_UPDCAL);
-  while ((pRtc->RTC_SR & RTC_SR_ACKUPD) != RTC_SR_ACKUPD);
+}
+
+extern void RTC_CancelTimeAndDateUpdate(Rtc *const pRtc)
+{
+  pRtc->RTC_CR &= ~((uint32_t) RTC_CR_UPDTIM | (uint32_t) RTC_CR_UPDCAL);
+  pRtc->RTC_SCCR = RTC_SCCR_ACKCLR;
+}
+
+extern void RTC_SelectWakeup(Rtc *const pRtc, const uint32_t wakeup)
+{
+  if (wakeup == RTC_WAKEUP_SECOND) {
+    if ((pRtc->RTC_IMR & RTC_IMR_SEC) != RTC_IMR_SEC) {
+      pRtc->RTC_SCCR = RTC_SCCR_SECCLR;
+      pRtc->RTC_IER = RTC_IER_SECEN;
+    }
+    pRtc->RTC_IDR = RTC_IDR_TIMDIS;
+  } else {
+    pRtc->RTC_CR = (pRtc->RTC_CR & ~RTC_CR_TIMEVSEL_Msk) | (wakeup & RTC_CR_TIMEVSEL_Msk);
+    if ((pRtc->RTC_IMR & RTC_IMR_TIM) != RTC_IMR_TIM) {
+      pRtc->RTC_SCCR = RTC_SCCR_TIMCLR;
+      pRtc->RTC_IER = RTC_IER_TIMEN;
+    }
+    pRtc->RTC_IDR = RTC_IDR_SECDIS;
+  }
+}
+
+extern unsigned RTC_CommitTimeAndDate(Rtc *const pRtc, const uint32_t timeReg, const uint32_t calReg,
+    const uint32_t rtc12hrsMode)
+{
+  if ((pRtc->RTC_SR & RTC_SR_ACKUPD) != RTC_SR_ACKUPD) {
+    return (pRtc->RTC_VER & (RTC_VER_NVCAL | RTC_VER_NVTIM | RTC_VER_NVCALALR | RTC_VER_NVTIMALR))
+        | getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc) | (1 << RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED);
+  }
+
+  const uint32_t current12HrsMode = (pRtc->RTC_MR & RTC_MR_HRMOD);
   pRtc->RTC_SCCR = RTC_SCCR_ACKCLR;
 
   pRtc->RTC_MR = rtc12hrsMode & RTC_MR_HRMOD;
   pRtc->RTC_TIMR = timeReg;
   pRtc->RTC_CALR = calReg;
   pRtc->RTC_CR &= ~((uint32_t) RTC_CR_UPDTIM | (uint32_t) RTC_CR_UPDCAL);
-  pRtc->RTC_SCCR |= RTC_SCCR_SECCLR; /* clear SECENV in SCCR */
+  pRtc->RTC_SCCR = RTC_SCCR_SECCLR; /* clear SECENV in SCCR */
 
   if(rtc12hrsMode != current12HrsMode) {
     if (pRtc->RTC_TIMALR & RTC_TIMALR_HOUREN) {
@@ -349,18 +842,43 @@ extern unsigned RTC_SetTimeAndDate(Rtc *const pRtc, const uint32_t timeReg, cons
       | getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc);
 }
 
+extern unsigned RTC_CommitTimeDateAndAlarm(Rtc *const pRtc, const uint32_t timeReg, const uint32_t calReg,
+    const uint32_t rtc12hrsMode, const uint32_t timeAlarmReg, const uint32_t calAlarmReg)
+{
+  if ((pRtc->RTC_SR & RTC_SR_ACKUPD) != RTC_SR_ACKUPD) {
+    return (pRtc->RTC_VER & (RTC_VER_NVCAL | RTC_VER_NVTIM | RTC_VER_NVCALALR | RTC_VER_NVTIMALR))
+        | getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc) | (1 << RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED);
+  }
+
+  pRtc->RTC_SCCR = RTC_SCCR_ACKCLR;
+
+  pRtc->RTC_MR = rtc12hrsMode & RTC_MR_HRMOD;
+  pRtc->RTC_TIMR = timeReg;
+  pRtc->RTC_CALR = calReg;
+  /* The RTC is stopped. No alarm can match in between. */
+  pRtc->RTC_TIMALR = timeAlarmReg;
+  pRtc->RTC_CALALR = calAlarmReg;
+  pRtc->RTC_SCCR = RTC_SCCR_ALRCLR;
+  pRtc->RTC_CR &= ~((uint32_t) RTC_CR_UPDTIM | (uint32_t) RTC_CR_UPDCAL);
+  pRtc->RTC_SCCR = RTC_SCCR_SECCLR; /* clear SECENV in SCCR */
+
+  return (pRtc->RTC_VER & (RTC_VER_NVCAL | RTC_VER_NVTIM | RTC_VER_NVCALALR | RTC_VER_NVTIMALR))
+      | getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc);
+}
+
 extern unsigned RTC_SetTimeAndDateAlarm( Rtc* const pRtc, uint8_t ucHour,
     uint8_t ucMinute, uint8_t ucSecond, uint8_t ucMonth, uint8_t ucDay)
 {
-  RTC_DisableIt(pRtc, RTC_IER_ALREN);
+  const unsigned rtc12HourMode = (pRtc->RTC_MR & RTC_MR_HRMOD);
+  uint32_t dwAlarmTime;
+  uint32_t dwAlarmDate;
 
   {
     const uint8_t hour   = ucHour   != UINT8_MAX ? ucHour   : 12;
     const uint8_t minute = ucMinute != UINT8_MAX ? ucMinute :  0;
     const uint8_t second = ucSecond != UINT8_MAX ? ucSecond :  0;
 
-    const unsigned rtc12HourMode = (pRtc->RTC_MR & RTC_MR_HRMOD);
-    uint32_t dwAlarmTime = RTC_TimeToTimeReg(hour, minute, second, rtc12HourMode);
+    dwAlarmTime = RTC_TimeToTimeReg(hour, minute, second, rtc12HourMode);
 
     if( ucHour != UINT8_MAX )
     {
@@ -376,14 +894,12 @@ extern unsigned RTC_SetTimeAndDateAlarm( Rtc* const pRtc, uint8_t ucHour,
     {
       dwAlarmTime |= RTC_TIMALR_SECEN;
     }
-
-    pRtc->RTC_TIMALR = dwAlarmTime;
   }
 
   {
     const uint8_t month = ucMonth != UINT8_MAX ? ucMonth : 1;
     const uint8_t day = ucDay != UINT8_MAX ? ucDay : 1;
-    uint32_t dwAlarmDate = RTC_DateToCalReg(0, month, day, 0);
+    dwAlarmDate = RTC_DateToCalReg(0, month, day, 0);
 
     if( ucMonth  != UINT8_MAX )
     {
@@ -394,10 +910,45 @@ extern unsigned RTC_SetTimeAndDateAlarm( Rtc* const pRtc, uint8_t ucHour,
     {
       dwAlarmDate |= RTC_CALALR_DATEEN;
     }
+  }
+
+  /* Reject invalid values before touching the alarm registers. */
+  {
+    const unsigned invalid = invalidAlarmRetFlags(dwAlarmTime, rtc12HourMode, dwAlarmDate);
+    if (invalid)
+    {
+      return invalid;
+    }
+  }
+
+  RTC_DisableIt(pRtc, RTC_IER_ALREN);
+  pRtc->RTC_TIMALR = dwAlarmTime;
+  pRtc->RTC_CALALR = dwAlarmDate;
+  RTC_ClearSCCR(pRtc, RTC_SCCR_ALRCLR);
+  RTC_EnableIt(pRtc, RTC_IER_ALREN);
+
+  return (pRtc->RTC_VER & (RTC_VER_NVCAL | RTC_VER_NVTIM | RTC_VER_NVCALALR | RTC_VER_NVTIMALR))
+      | getTimeAlrEnRetFlags(pRtc) | getCalAlrEnRetFlags(pRtc);
+}
 
-    pRtc->RTC_CALALR = dwAlarmDate;
+extern unsigned RTC_SetTimeAndDateAlarmRegs( Rtc* const pRtc, const uint32_t timeAlarmReg24,
+    const uint32_t timeAlarmReg12, const uint32_t calAlarmReg)
+{
+  /* Reject invalid values before touching the alarm registers. */
+  {
+    const unsigned invalid = invalidAlarmRetFlags(timeAlarmReg24, 0, calAlarmReg)
+                           | invalidAlarmRetFlags(timeAlarmReg12, 1, calAlarmReg);
+    if (invalid)
+    {
+      return invalid;
+    }
   }
 
+  RTC_DisableIt(pRtc, RTC_IER_ALREN);
+
+  pRtc->RTC_TIMALR = (pRtc->RTC_MR & RTC_MR_HRMOD) ? timeAlarmReg12 : timeAlarmReg24;
+  pRtc->RTC_CALALR = calAlarmReg;
+
   RTC_ClearSCCR(pRtc, RTC_SCCR_ALRCLR);
   RTC_EnableIt(pRtc, RTC_IER_ALREN);
 
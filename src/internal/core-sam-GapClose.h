@@ -42,6 +42,21 @@ extern "C" {
 #define RTC_RET_BITPOS_TIMALR_MINEN   5
 #define RTC_RET_BITPOS_TIMALR_SECEN   4
 
+// Time and date did not get stable within the retry limit
+#define RTC_RET_BITPOS_READ_UNSTABLE  12
+
+// Time and date update has not been acknowledged by the RTC
+#define RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED 13
+
+/*
+ * Maximum number of re-reads of RTC_TIMR and RTC_CALR, until both are
+ * stable. The registers change once per second, so a single retry is
+ * normally sufficient.
+ */
+#ifndef RTC_READ_RETRY_LIMIT
+  #define RTC_READ_RETRY_LIMIT 4
+#endif
+
 /**
  * \brief Retrieves the current time and current date as stored in the RTC.
  * Month, day and week values are numbered starting at 1.
@@ -65,7 +80,9 @@ extern "C" {
  *
  *
  * \return Contents of RTC Valid Entry Register in bit[0..3], time alarm enabled flags
- *    in bit[4..6], cal alarm enabled flags in bit[8..9]..
+ *    in bit[4..6], cal alarm enabled flags in bit[8..9]. Bit[RTC_RET_BITPOS_READ_UNSTABLE]
+ *    is set, if time and date did not get stable within RTC_READ_RETRY_LIMIT re-reads.
+ *    None of the variables is set then.
  */
 extern unsigned RTC_GetTimeAndDate( Rtc* const pRtc, uint8_t* const pucAMPM,
     uint8_t* const pucHour, uint8_t* const pucMinute, uint8_t* const pucSecond,
@@ -73,15 +90,140 @@ extern unsigned RTC_GetTimeAndDate( Rtc* const pRtc, uint8_t* const pucAMPM,
     uint8_t* const pucWeek, uint8_t* const pucRtc12HrsMode );
 
 /**
- * \brief Sets the current time and date in the RTC.
- * Month, day and week values must be numbered starting from 1. The passed hour
- * must be in 24 hour representation, independent of whether the RTC is running
- * in 12 hour mode, or 24-hrs mode. An adjusted ucHour may used to always
- * to match the current RTC hour mode. The RTC hour mode will not be changed.
+ * \brief Raw contents of the RTC time, calendar and mode register, that
+ * have been read consistently. I.e. RTC_TIMR and RTC_CALR belong to the
+ * same second.
+ */
+typedef struct {
+  uint32_t timr;
+  uint32_t calr;
+  uint32_t mr;
+} RtcTimeSnapshot;
+
+/**
+ * \brief Retrieves the current time and current date as stored in the RTC
+ * without decoding them. Other than RTC_GetTimeAndDate(), neither RTC_VER nor
+ * the alarm registers are read.
+ * Register accesses: RTC_TIMR 2x, RTC_CALR 2x and RTC_MR 1x in case time and
+ * date were stable during the first read. RTC_GetTimeAndDate() additionally
+ * reads RTC_VER, RTC_TIMALR and RTC_CALALR.
+ *
+ * \note The re-reads are not bounded. The library reads by
+ * RTC_ReadTimeSnapshot() only.
+ *
+ * \return The register contents.
+ */
+extern RtcTimeSnapshot RTC_GetTimeSnapshot( Rtc* const pRtc );
+
+#define RTC_READ_UNSTABLE (-1)
+
+/**
+ * \brief Same as RTC_GetTimeSnapshot(), but with a bounded number of
+ * re-reads. Thus the worst case execution time is known.
+ *
+ * \param pSnapshot  Receives the register contents. Left unchanged, if
+ *                   the registers did not get stable.
+ * \param maxRetries Maximum number of re-reads of RTC_TIMR or RTC_CALR.
+ *
+ * \return The number of re-reads that were needed [0..maxRetries], or
+ *    RTC_READ_UNSTABLE if the registers did not get stable.
+ */
+extern int RTC_ReadTimeSnapshot( Rtc* const pRtc, RtcTimeSnapshot* const pSnapshot,
+    const unsigned maxRetries );
+
+/**
+ * \brief Retrieves the RTC_TIMR register contents along with the hour mode,
+ * without reading RTC_CALR. RTC_TIMR is re-read until it is stable. RTC_MR
+ * is read before and after, so that an hour mode change in between is
+ * detected as well.
+ * Register accesses: RTC_TIMR 2x and RTC_MR 2x in case time was stable
+ * during the first read.
+ *
+ * \param pTimeReg      Receives the contents of RTC_TIMR.
+ * \param pRtc12HrsMode Receives the hour mode that the RTC is running in:
+ *                         0: RTC runs in 24-hrs mode.
+ *                         1: RTC runs in 12-hrs mode.
+ * \param maxRetries    Maximum number of re-reads.
+ *
+ * \return The number of re-reads that were needed [0..maxRetries], or
+ *    RTC_READ_UNSTABLE. None of the variables is set then.
+ */
+extern int RTC_ReadTimeReg( Rtc* const pRtc, uint32_t* const pTimeReg, uint32_t* const pRtc12HrsMode,
+    const unsigned maxRetries );
+
+/**
+ * \brief Retrieves the RTC_CALR register contents without reading RTC_TIMR.
+ * RTC_CALR is re-read until it is stable, which also covers the midnight
+ * transition.
+ * Register accesses: RTC_CALR 2x in case date was stable during the first
+ * read.
+ *
+ * \param pCalReg    Receives the contents of RTC_CALR.
+ * \param maxRetries Maximum number of re-reads.
+ *
+ * \return The number of re-reads that were needed [0..maxRetries], or
+ *    RTC_READ_UNSTABLE. *pCalReg is not set then.
+ */
+extern int RTC_ReadCalReg( Rtc* const pRtc, uint32_t* const pCalReg, const unsigned maxRetries );
+
+/**
+ * \brief Retrieves the RTC Valid Entry Register.
+ *
+ * \return Contents of RTC Valid Entry Register in bit[0..3].
+ */
+extern unsigned RTC_GetValidEntry( Rtc* const pRtc );
+
+/**
+ * \brief Retrieves the alarm enabled flags.
+ *
+ * \return Time alarm enabled flags in bit[4..6], cal alarm enabled flags in bit[8..9].
+ */
+extern unsigned RTC_GetAlarmEnRetFlags( Rtc* const pRtc );
+
+/**
+ * \brief Requests the update of the time and calendar registers by setting
+ * UPDTIM and UPDCAL in RTC_CR. Does not wait. The RTC stops counting and
+ * sets RTC_SR_ACKUPD within one second, which fires the ACKUPD interrupt,
+ * when enabled. Then, RTC_CommitTimeAndDate() is to be called.
  *
  * \note In successive update operations, the user must wait at least one second
  * after resetting the UPDTIM/UPDCAL bit in the RTC_CR before setting these
  * bits again. Please look at the RTC section of the data sheet for detail.
+ */
+extern void RTC_RequestTimeAndDateUpdate(Rtc *const pRtc);
+
+/**
+ * \brief Withdraws an update request. The RTC continues counting with the
+ * unchanged time and date.
+ */
+extern void RTC_CancelTimeAndDateUpdate(Rtc *const pRtc);
+
+#define RTC_WAKEUP_SECOND UINT32_MAX
+
+/**
+ * \brief Selects the RTC interrupt, that wakes up the CPU next. Either the
+ * second interrupt, or the time event interrupt upon each minute or each
+ * hour change. The other one is disabled. The flag of a newly enabled event
+ * is cleared before, so that a stale event doesn't fire the interrupt
+ * immediately.
+ * Register accesses: RTC_IMR 1x, RTC_IER 0..1x, RTC_IDR 1x, RTC_SCCR 0..1x
+ * and RTC_CR 2x in case of the time event.
+ *
+ * \param wakeup RTC_WAKEUP_SECOND, RTC_CR_TIMEVSEL_MINUTE or RTC_CR_TIMEVSEL_HOUR.
+ */
+extern void RTC_SelectWakeup(Rtc *const pRtc, const uint32_t wakeup);
+
+/**
+ * \brief Writes the time and date to the RTC after the update has been
+ * acknowledged by RTC_SR_ACKUPD, and lets the RTC continue. RTC_SR_ACKUPD is
+ * checked once, not polled. If it is not set, nothing is written.
+ * The passed hour mode is applied. The hour of an enabled time alarm is
+ * converted when the hour mode changes.
+ *
+ * Execution time is bounded, there are no loops. Register accesses: RTC_SR 1x,
+ * RTC_MR 2x, RTC_TIMR 1x, RTC_CALR 1x, RTC_CR 2x, RTC_SCCR 2x, RTC_VER 1x,
+ * RTC_TIMALR 1x and RTC_CALALR 1x. When the hour mode changes, there are up
+ * to 6 additional RTC_TIMALR accesses for converting the alarm hour.
  *
  * \param timeReg      The contents of the RTC_TIMR register.
  * \param calReg       The contents of the RTC_CALR register.
@@ -90,11 +232,36 @@ extern unsigned RTC_GetTimeAndDate( Rtc* const pRtc, uint8_t* const pucAMPM,
  *                   1: 12-hrs mode.
  *
  * \return Contents of RTC Valid Entry Register in bit[0..3], time alarm enabled flags
- *    in bit[4..6], cal alarm enabled flags in bit[8..9]..
+ *    in bit[4..6], cal alarm enabled flags in bit[8..9]. Bit[RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED]
+ *    is set, if the update has not been acknowledged yet.
  */
-extern unsigned RTC_SetTimeAndDate(Rtc *const pRtc, const uint32_t timeReg, const uint32_t calReg,
+extern unsigned RTC_CommitTimeAndDate(Rtc *const pRtc, const uint32_t timeReg, const uint32_t calReg,
     const uint32_t rtc12hrsMode);
 
+/**
+ * \brief Same as RTC_CommitTimeAndDate(), but the time alarm and the
+ * calendar alarm are written as well, while the RTC is stopped. So the
+ * alarm never applies to the time before the update and the previous
+ * alarm never applies to the new time. A pending alarm event is cleared.
+ *
+ * Execution time is bounded, there are no loops. Register accesses: RTC_SR 1x,
+ * RTC_MR 1x, RTC_TIMR 1x, RTC_CALR 1x, RTC_TIMALR 2x, RTC_CALALR 2x, RTC_CR 2x,
+ * RTC_SCCR 3x and RTC_VER 1x.
+ *
+ * \param timeReg      The contents of the RTC_TIMR register.
+ * \param calReg       The contents of the RTC_CALR register.
+ * \param rtc12hrsMode The hour mode in which the RTC should run:
+ *                   0: 24-hrs mode.
+ *                   1: 12-hrs mode.
+ * \param timeAlarmReg The contents of the RTC_TIMALR register. Must be
+ *                   in the hour mode given by rtc12hrsMode.
+ * \param calAlarmReg  The contents of the RTC_CALALR register.
+ *
+ * \return See RTC_CommitTimeAndDate().
+ */
+extern unsigned RTC_CommitTimeDateAndAlarm(Rtc *const pRtc, const uint32_t timeReg, const uint32_t calReg,
+    const uint32_t rtc12hrsMode, const uint32_t timeAlarmReg, const uint32_t calAlarmReg);
+
 /**
  * \brief Retrieves the alarm time as stored in the RTC.
  *
@@ -142,12 +309,30 @@ extern unsigned RTC_GetDateAlarm( Rtc* const pRtc, uint8_t* const pucMonth, uint
  * \param ucDay     If not UINT8_MAX, the RTC alarm will day-match this value.
  *
  * \return Contents of RTC Valid Entry Register in bit[0..3], time alarm enabled flags
- *    in bit[4..6], cal alarm enabled flags in bit[8..9].
+ *    in bit[4..6], cal alarm enabled flags in bit[8..9]. Invalid values are
+ *    rejected without touching the alarm registers. The not valid flags are
+ *    set for them then.
  */
 extern unsigned RTC_SetTimeAndDateAlarm( Rtc* const pRtc, uint8_t ucHour, uint8_t ucMinute,
     uint8_t ucSecond, uint8_t ucMonth, uint8_t ucDay) ;
 
 
+/**
+ * \brief Sets a time alarm and date on the RTC by passing precalculated register
+ * contents, e.g. the ones provided by RtcAlarmRegs.
+ *
+ * \param timeAlarmReg24 Contents of RTC_TIMALR to be written, if the RTC runs in 24-hrs mode.
+ * \param timeAlarmReg12 Contents of RTC_TIMALR to be written, if the RTC runs in 12-hrs mode.
+ * \param calAlarmReg    Contents of RTC_CALALR to be written.
+ *
+ * \return Contents of RTC Valid Entry Register in bit[0..3], time alarm enabled flags
+ *    in bit[4..6], cal alarm enabled flags in bit[8..9]. Invalid values are
+ *    rejected without touching the alarm registers. The not valid flags are
+ *    set for them then.
+ */
+extern unsigned RTC_SetTimeAndDateAlarmRegs( Rtc* const pRtc, const uint32_t timeAlarmReg24,
+    const uint32_t timeAlarmReg12, const uint32_t calAlarmReg);
+
 /**
  * \brief calculate the RTC_TIMR bcd format.
  *
@@ -210,6 +395,76 @@ extern uint32_t RTC_DateToCalReg(const uint16_t wYear, const uint8_t ucMonth, co
 extern void RTC_CalRegToDate( uint32_t calReg, uint16_t* const pwYear, uint8_t* const pucMonth,
     uint8_t* const pucDay, uint8_t* const pucWeek );
 
+/**
+ * \brief Check the contents for the RTC_TIMR register before writing it.
+ * All bcd digits and field ranges are checked at once (SWAR), like the RTC
+ * does it after an update.
+ *
+ * \param timeReg    The contents for the RTC_TIMR register.
+ * \param timeReg12HrsMode
+ *                   0: Contents of the timer register is 24-hrs mode.
+ *                   1: Contents of the timer register is 12-hrs mode.
+ *
+ * \return 1 if valid, 0 otherwise.
+ */
+extern unsigned RTC_IsValidTimeReg(const uint32_t timeReg, const uint32_t timeReg12HrsMode);
+
+/**
+ * \brief Check the contents for the RTC_CALR register before writing it.
+ * All bcd digits, field ranges and the days of the month incl. leap years
+ * are checked.
+ *
+ * \param calReg     The contents for the RTC_CALR register.
+ *
+ * \return 1 if valid, 0 otherwise.
+ */
+extern unsigned RTC_IsValidCalReg(const uint32_t calReg);
+
+/**
+ * \brief Check the contents for the RTC_TIMALR register before writing it.
+ *
+ * \param timeAlarmReg The contents for the RTC_TIMALR register.
+ * \param timeReg12HrsMode
+ *                   0: Contents of the alarm register is 24-hrs mode.
+ *                   1: Contents of the alarm register is 12-hrs mode.
+ *
+ * \return 1 if valid, 0 otherwise.
+ */
+extern unsigned RTC_IsValidTimeAlarmReg(const uint32_t timeAlarmReg, const uint32_t timeReg12HrsMode);
+
+/**
+ * \brief Check the contents for the RTC_CALALR register before writing it.
+ *
+ * \param calAlarmReg The contents for the RTC_CALALR register.
+ *
+ * \return 1 if valid, 0 otherwise.
+ */
+extern unsigned RTC_IsValidCalAlarmReg(const uint32_t calAlarmReg);
+
+#ifdef TEST_RtcDueRcf
+
+/**
+ * \brief Both bcd codec implementations, made accessible for comparing
+ * results and execution time. The one selected by RTC_BCD_CODEC_LOOKUP_TABLE
+ * is used by RTC_TimeToTimeReg(), RTC_TimeRegToTime(), RTC_DateToCalReg()
+ * and RTC_CalRegToDate().
+ */
+typedef struct {
+  uint32_t (*timeToTimeReg)(uint8_t ucHour, const uint8_t ucMinute, const uint8_t ucSecond,
+      const uint32_t timeReg12HrsMode);
+  void (*timeRegToTime)(uint32_t timeReg, uint8_t* const pucAMPM, uint8_t* const pucHour,
+      uint8_t* const pucMinute, uint8_t* const pucSecond, const uint32_t timeReg12HrsMode);
+  uint32_t (*dateToCalReg)(const uint16_t wYear, const uint8_t ucMonth, const uint8_t ucDay,
+      const uint8_t ucWeek);
+  void (*calRegToDate)(uint32_t calReg, uint16_t* const pwYear, uint8_t* const pucMonth,
+      uint8_t* const pucDay, uint8_t* const pucWeek);
+} RtcBcdCodec;
+
+extern const RtcBcdCodec RTC_BcdCodecArithmetic;
+extern const RtcBcdCodec RTC_BcdCodecLookupTable;
+
+#endif // TEST_RtcDueRcf
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,10 @@
 #include "../TM.h"
 #include "../RtcDueRcf.h"
 #include "../internal/core-sam-GapClose.h"
+#include "../internal/RtcDstTransitionCache.h"
+#include "../internal/RtcSnapshot.h"
+#include "../internal/RtcTimeZone.h"
+#include "../internal/RtcZoneView.h"
 #include "Arduino.h"
 
 namespace Sam3XA {
@@ -99,6 +103,24 @@ uint32_t getHourMode( Rtc* pRtc )
     return pRtc->RTC_MR & 0x00000001;
 }
 
+// Start the Cortex-M3 DWT cycle counter.
+void startCycleCounter() {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+inline uint32_t cycleCount() {
+  return DWT->CYCCNT;
+}
+
+void logCycles(Stream& log, const char* what, uint32_t cycles, uint32_t n) {
+  log.print(what);
+  log.print(": ");
+  log.print(cycles / n);
+  log.println(" cycles");
+}
+
 } // anonymous namespace
 
 namespace RtcDueRcf_test {
@@ -110,10 +132,7 @@ static void testBasicSetGet(Stream &log) {
   TM stime;
   std::mktime(&stime); // Fix tm_yday, tm_wday and tm_isdst
 
-#if RTC_MEASURE_ACKUPD
-  uint32_t timestamp_setClock = millis();
-#endif
-
+  const uint32_t commits = RtcDueRcf::clock.getSetTrace().count();
   assert(RtcDueRcf::clock.setTime(stime));
   log.println(stime);
 
@@ -135,13 +154,13 @@ static void testBasicSetGet(Stream &log) {
   const std::time_t timestamp = std::mktime(&stime);
   assert(localtime == timestamp + 1);
 
-#if RTC_MEASURE_ACKUPD
-  // Measure the set clock - latency an print.
-  uint32_t setClockLatency = RtcDueRcf::clock.getTimestampACKUPD() - timestamp_setClock;
-  log.print("--- set clock latency: ");
-  log.print(setClockLatency);
-  log.println("ms");
-#endif
+  // Trace of the set clock latency.
+  const RtcDueRcf_SetTrace trace = RtcDueRcf::clock.getSetTrace();
+  assert(trace.count() == commits + 1);
+  assert(trace[trace.size() - 1].source == RtcDueRcf_SetTrace::REQUEST);
+  assert(trace[trace.size() - 1].ackLatency() < 1100000);
+  log.print("--- set clock trace: ");
+  log.println(trace);
 }
 
 static void testDstEntry(Stream& log) {
@@ -286,6 +305,510 @@ static void check12hourRepresentation(Stream& log, TM& stime, uint8_t expectedAM
   delay(100);
 }
 
+static void testSnapshotRead(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  constexpr uint32_t N = 1000;
+  startCycleCounter();
+
+  uint8_t hour; uint8_t minute; uint8_t second;
+  uint16_t year; uint8_t month; uint8_t day; uint8_t week;
+  uint8_t rtc12HrsMode;
+
+  // Former read path: 11 register accesses per read.
+  volatile unsigned sink = 0;
+  uint32_t start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    sink = RTC_GetTimeAndDate(RTC, nullptr, &hour, &minute, &second, &year, &month, &day,
+        &week, &rtc12HrsMode);
+  }
+  logCycles(log, "RTC_GetTimeAndDate", cycleCount() - start, N);
+
+  // Snapshot read path: 6 register accesses per read.
+  start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    Sam3XA::RtcSnapshot snapshot;
+    snapshot.readFromRtc();
+    sink = Sam3XA::RtcSnapshot::validEntryRegister();
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.set(snapshot);
+  }
+  logCycles(log, "RtcSnapshot + RTC_VER + decode", cycleCount() - start, N);
+  (void)sink;
+
+  // Both must retrieve the same time.
+  Sam3XA::RtcSnapshot snapshot;
+  do {
+    RTC_GetTimeAndDate(RTC, nullptr, &hour, &minute, &second, &year, &month, &day,
+        &week, &rtc12HrsMode);
+    snapshot.readFromRtc();
+  } while(snapshot.second() != second);
+  assert(snapshot.hour() == hour && snapshot.minute() == minute);
+  assert(snapshot.year() == year && snapshot.month() == month && snapshot.day() == day);
+  assert(snapshot.day_of_week() == week && snapshot.rtc12hrsMode() == rtc12HrsMode);
+  delay(100);
+}
+
+static void testTimeStampDecode(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  constexpr uint32_t N = 1000;
+  startCycleCounter();
+
+  // Former path as used by the SetUtcTime example.
+  volatile std::time_t sink = 0;
+  uint32_t start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    std::tm time;
+    RtcDueRcf::clock.getLocalTime(time);
+    sink = mktime(&time);
+  }
+  logCycles(log, "getLocalTime + mktime", cycleCount() - start, N);
+
+  // Fused register to time stamp decoder.
+  start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    Sam3XA::RtcSnapshot snapshot;
+    snapshot.readFromRtc();
+    sink = snapshot.utcTimeStamp();
+  }
+  logCycles(log, "RtcSnapshot + utcTimeStamp", cycleCount() - start, N);
+  (void)sink;
+
+  // Both must retrieve the same time stamp.
+  std::time_t expected;
+  std::time_t timeStamp;
+  do {
+    std::tm time;
+    RtcDueRcf::clock.getLocalTime(time);
+    expected = mktime(&time);
+    Sam3XA::RtcSnapshot snapshot;
+    snapshot.readFromRtc();
+    timeStamp = snapshot.utcTimeStamp();
+  } while(timeStamp == expected + 1 /* second has elapsed in between */);
+  assert(timeStamp == expected);
+  delay(100);
+}
+
+static void testSeqlockRead(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  delay(1100); // Let the second interrupt publish the time.
+
+  constexpr uint32_t N = 1000;
+  startCycleCounter();
+
+  volatile int sink = 0;
+  uint32_t start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    std::tm time;
+    RtcDueRcf::clock.getLocalTime(time);
+    sink = time.tm_sec;
+  }
+  logCycles(log, "getLocalTime from seqlock", cycleCount() - start, N);
+
+  start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    std::tm time;
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.readFromRtc();
+    rtcTime.get(time);
+    sink = time.tm_sec;
+  }
+  logCycles(log, "RTC register read", cycleCount() - start, N);
+  (void)sink;
+
+  // Both must retrieve the same time.
+  std::tm time;
+  Sam3XA::RtcTime rtcTime;
+  do {
+    rtcTime.readFromRtc();
+    assert(RtcDueRcf::clock.getLocalTime(time));
+  } while(time.tm_sec != rtcTime.tm_sec()); // Second interrupt not yet serviced.
+  assert(time.tm_min == rtcTime.tm_min() && time.tm_hour == rtcTime.tm_hour());
+  assert(time.tm_mday == rtcTime.tm_mday() && time.tm_mon == rtcTime.tm_mon());
+  assert(time.tm_year == rtcTime.tm_year() && time.tm_isdst == rtcTime.rtc12hrsMode());
+  delay(100);
+}
+
+static void testEventDrivenReads(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  RtcDueRcf::clock.setEventDrivenDstCheck(true);
+  delay(1100); // Let the second interrupt select the time event wake up.
+
+  // The second interrupt doesn't republish the time any more. The time
+  // must follow the RTC registers anyway.
+  const uint32_t start = millis();
+  while(millis() - start < 3000) {
+    std::tm time;
+    Sam3XA::RtcTime before;
+    Sam3XA::RtcTime after;
+    before.readFromRtc();
+    assert(RtcDueRcf::clock.getLocalTime(time));
+    after.readFromRtc();
+    if(before.tm_sec() == after.tm_sec()) { // No second transition in between.
+      assert(time.tm_sec == before.tm_sec() && time.tm_min == before.tm_min());
+      assert(time.tm_hour == before.tm_hour() && time.tm_mday == before.tm_mday());
+      assert(time.tm_isdst == before.rtc12hrsMode());
+    }
+  }
+  RtcDueRcf::clock.setEventDrivenDstCheck(false);
+  delay(100);
+}
+
+static void testTimeWithMicros(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  delay(1100); // Let the second interrupt publish the time.
+
+  // Monotonic over 3 seconds.
+  std::tm time;
+  uint32_t microseconds;
+  assert(RtcDueRcf::clock.getTimeWithMicros(time, microseconds));
+  int64_t previous = ((time.tm_hour * 60 + time.tm_min) * 60 + time.tm_sec) * 1000000LL + microseconds;
+  const uint32_t start = millis();
+  while(millis() - start < 3000) {
+    assert(RtcDueRcf::clock.getTimeWithMicros(time, microseconds));
+    assert(microseconds < 1000000);
+    const int64_t current = ((time.tm_hour * 60 + time.tm_min) * 60 + time.tm_sec) * 1000000LL + microseconds;
+    assert(current >= previous);
+    previous = current;
+  }
+
+  // UTC time must fit to the local time.
+  timespec utcTime;
+  std::tm localTime;
+  do {
+    assert(RtcDueRcf::clock.getTimeWithMicros(utcTime));
+    assert(RtcDueRcf::clock.getLocalTime(localTime));
+  } while(utcTime.tv_nsec > 900000000); // Avoid the second boundary.
+  assert(utcTime.tv_sec == mktime(&localTime));
+  delay(100);
+}
+
+static void testBoundedRead(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  RtcDueRcf::clock.resetReadStatistics();
+
+  // Without re-reads, a read fails when it straddles a second transition.
+  Sam3XA::RtcSnapshot snapshot;
+  uint32_t n = 0;
+  uint32_t unstable = 0;
+  const uint32_t start = millis();
+  while(millis() - start < 2100) {
+    const int retries = snapshot.readFromRtc(0);
+    assert(retries == 0 || retries == RTC_READ_UNSTABLE);
+    if(retries == RTC_READ_UNSTABLE) {
+      unstable++;
+    }
+    n++;
+  }
+  log.print("  Unstable reads without re-read: ");
+  log.print(unstable);
+  log.print(" of ");
+  log.println(n);
+
+  // The second interrupt has read the RTC with the default retry limit.
+  const RtcDueRcf_ReadStatistics statistics = RtcDueRcf::clock.getReadStatistics();
+  log.print("  ");
+  log.println(statistics);
+  assert(statistics.reads() >= 2);
+  assert(statistics.failures() == 0);
+  assert(statistics.maxRetries() <= RTC_READ_RETRY_LIMIT);
+  uint32_t sum = 0;
+  for(size_t i = 0; i < RtcDueRcf_ReadStatistics::HISTOGRAM_SIZE; i++) {
+    sum += statistics.histogram(i);
+  }
+  assert(sum == statistics.reads());
+
+  RtcDueRcf::clock.resetReadStatistics();
+  assert(RtcDueRcf::clock.getReadStatistics().failures() == 0);
+  delay(100);
+}
+
+static void testUtcTimestamp(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // Standard time and daylight savings time.
+  const int tm_mon[2] = {0, 6};
+  for(size_t i = 0; i < 2; i++) {
+    TM stime(30, 0, 12, 15, tm_mon[i], TM::make_tm_year(2016), -1);
+    assert(RtcDueRcf::clock.setTime(stime));
+    delay(1100); // Let the time be written to the RTC.
+
+    TM localTime;
+    std::time_t utcTimestamp;
+    assert(RtcDueRcf::clock.getTime(localTime, utcTimestamp));
+    assert(localTime.tm_isdst == static_cast<int>(i));
+    const std::time_t utcTimestamp2 = RtcDueRcf::clock.getUtcTimestamp();
+    assert(utcTimestamp2 == utcTimestamp || utcTimestamp2 == utcTimestamp + 1);
+    assert(utcTimestamp == std::mktime(&localTime));
+  }
+
+  constexpr uint32_t N = 100;
+  volatile std::time_t sink = 0;
+  startCycleCounter();
+  uint32_t start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    TM localTime;
+    RtcDueRcf::clock.getLocalTime(localTime);
+    sink = std::mktime(&localTime);
+  }
+  logCycles(log, "getLocalTime + mktime", cycleCount() - start, N);
+
+  start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    TM localTime;
+    std::time_t utcTimestamp;
+    RtcDueRcf::clock.getTime(localTime, utcTimestamp);
+    sink = utcTimestamp;
+  }
+  logCycles(log, "getTime", cycleCount() - start, N);
+  (void)sink;
+  delay(100);
+}
+
+static void testTimeOfDayAndDate(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // 2 seconds before midnight.
+  TM stime(58, 59, 23, 31, 11, TM::make_tm_year(2023), -1);
+  assert(RtcDueRcf::clock.setTime(stime));
+  delay(500); // Let the time be written to the RTC.
+
+  // Must fit to a full read and cross midnight exactly once.
+  int mdayChanges = 0;
+  TM previousDate;
+  assert(RtcDueRcf::clock.getDate(previousDate));
+  const uint32_t start = millis();
+  while(millis() - start < 4000) {
+    TM time;
+    TM date;
+    Sam3XA::RtcTime rtcTime;
+    do {
+      rtcTime.readFromRtc();
+      assert(RtcDueRcf::clock.getTimeOfDay(time));
+      assert(RtcDueRcf::clock.getDate(date));
+    } while(time.tm_sec != rtcTime.tm_sec() || date.tm_mday != rtcTime.tm_mday()); // Second transition.
+    assert(time.tm_min == rtcTime.tm_min() && time.tm_hour == rtcTime.tm_hour());
+    assert(time.tm_isdst == rtcTime.rtc12hrsMode());
+    assert(date.tm_mon == rtcTime.tm_mon() && date.tm_year == rtcTime.tm_year());
+    assert(date.tm_wday == rtcTime.tm_wday());
+    if(date.tm_mday != previousDate.tm_mday) {
+      mdayChanges++;
+      assert(date.tm_mday == 1 && date.tm_mon == 0 && date.tm_year == TM::make_tm_year(2024));
+      assert(date.tm_yday == 0);
+    }
+    previousDate = date;
+  }
+  assert(mdayChanges == 1);
+
+  constexpr uint32_t N = 100;
+  volatile int sink = 0;
+  startCycleCounter();
+  uint32_t start_ = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    std::tm time;
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.readFromRtc();
+    rtcTime.get(time);
+    sink = time.tm_hour;
+  }
+  logCycles(log, "RTC register read (time and date)", cycleCount() - start_, N);
+
+  start_ = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    std::tm time;
+    RtcDueRcf::clock.getTimeOfDay(time);
+    sink = time.tm_hour;
+  }
+  logCycles(log, "getTimeOfDay", cycleCount() - start_, N);
+
+  start_ = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    std::tm date;
+    RtcDueRcf::clock.getDate(date);
+    sink = date.tm_mday;
+  }
+  logCycles(log, "getDate", cycleCount() - start_, N);
+  (void)sink;
+  delay(100);
+}
+
+static volatile uint32_t commitCallbackCount = 0;
+static volatile uint32_t commitCallbackLatency = 0;
+
+static void commitCallback(void*, uint32_t latencyMicros) {
+  commitCallbackCount = commitCallbackCount + 1;
+  commitCallbackLatency = latencyMicros;
+}
+
+static void testCommitNotification(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  RtcDueRcf::clock.setCommitCallback(commitCallback);
+  commitCallbackCount = 0;
+
+  TM stime(0, 30, 10, 1, 5, TM::make_tm_year(2022), -1);
+  assert(RtcDueRcf::clock.setTime(stime));
+  const uint32_t ticket = RtcDueRcf::clock.getSetTimeTicket();
+  assert(not RtcDueRcf::clock.isCommitted(ticket));
+
+  const uint32_t start = millis();
+  while(not RtcDueRcf::clock.isCommitted(ticket)) {
+    assert(millis() - start < 1500);
+  }
+  assert(commitCallbackCount == 1);
+  assert(commitCallbackLatency == RtcDueRcf::clock.getCommitLatency());
+  assert(commitCallbackLatency > 0 && commitCallbackLatency < 1100000);
+  log.print("  Commit latency: ");
+  log.print(commitCallbackLatency);
+  log.println("us");
+
+  // Committed: The RTC holds the time.
+  Sam3XA::RtcTime rtcTime;
+  rtcTime.readFromRtc();
+  assert(rtcTime.tm_hour() == 10 && rtcTime.tm_min() == 30 && rtcTime.tm_sec() == 0);
+  assert(rtcTime.tm_mday() == 1 && rtcTime.tm_mon() == 5 && rtcTime.tm_year() == TM::make_tm_year(2022));
+
+  RtcDueRcf::clock.setCommitCallback(nullptr);
+  delay(100);
+}
+
+static void waitForCommit(const uint32_t ticket) {
+  const uint32_t start = millis();
+  while(not RtcDueRcf::clock.isCommitted(ticket)) {
+    assert(millis() - start < 1500);
+  }
+}
+
+static void testCoalescedSetTime(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // Back to back requests: only the latest one is written.
+  {
+    const uint32_t superseded = RtcDueRcf::clock.getSupersededCount();
+    const uint32_t commits = RtcDueRcf::clock.getSetTrace().count();
+    TM stime(0, 0, 8, 1, 5, TM::make_tm_year(2022), -1);
+    assert(RtcDueRcf::clock.setTime(stime));
+    stime.tm_hour = 9;
+    assert(RtcDueRcf::clock.setTime(stime));
+    stime.tm_hour = 10;
+    assert(RtcDueRcf::clock.setTime(stime));
+    waitForCommit(RtcDueRcf::clock.getSetTimeTicket());
+    assert(RtcDueRcf::clock.getSupersededCount() == superseded + 2);
+    // A single commit.
+    const RtcDueRcf_SetTrace trace = RtcDueRcf::clock.getSetTrace();
+    assert(trace.count() == commits + 1);
+    assert(trace[trace.size() - 1].source == RtcDueRcf_SetTrace::REQUEST);
+    assert(trace.maximum(RtcDueRcf_SetTrace::COMMIT_DURATION) < 100);
+
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.readFromRtc();
+    assert(rtcTime.tm_hour() == 10 && rtcTime.tm_min() == 0);
+  }
+
+  // A daylight savings adjustment and a set time request of the user are
+  // pending together. The user request supersedes the adjustment, which
+  // must not get lost: It is repeated for the time of the user.
+  {
+    // Standard time 2 seconds before the daylight savings begin.
+    TM stime;
+    makeCETdstBeginTime(stime, 58, 59, 1, 0);
+    assert(RtcDueRcf::clock.setTime_(stime));
+    waitForCommit(RtcDueRcf::clock.getSetTimeTicket());
+
+    // The daylight savings check requests the RTC update upon 1:59:59h.
+    // The RTC acknowledges upon its next second.
+    const uint32_t start = millis();
+    while((RTC->RTC_CR & RTC_CR_UPDTIM) != RTC_CR_UPDTIM) {
+      assert(millis() - start < 2500);
+    }
+    const uint32_t supersededDst = RtcDueRcf::clock.getSupersededDstCount();
+    const uint32_t superseded = RtcDueRcf::clock.getSupersededCount();
+    makeCETdstBeginTime(stime, 0, 30, 2, 0); // 2:30h does not exist in standard time.
+    assert(RtcDueRcf::clock.setTime_(stime));
+    waitForCommit(RtcDueRcf::clock.getSetTimeTicket());
+    assert(RtcDueRcf::clock.getSupersededDstCount() == supersededDst + 1);
+    assert(RtcDueRcf::clock.getSupersededCount() == superseded);
+
+    // The time of the user has been written in 24-hrs mode.
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.readFromRtc();
+    assert(not rtcTime.rtc12hrsMode() && rtcTime.tm_hour() == 2 && rtcTime.tm_min() == 30);
+
+    // The next daylight savings check corrects the hour mode.
+    delay(2500);
+    rtcTime.readFromRtc();
+    assert(rtcTime.rtc12hrsMode() && rtcTime.tm_hour() == 3 && rtcTime.tm_min() == 30);
+    TM rtime;
+    assert(RtcDueRcf::clock.getLocalTime(rtime));
+    assert(rtime.tm_isdst && rtime.tm_hour == 3 && rtime.tm_min == 30);
+
+    // The daylight savings adjustment is traced.
+    const RtcDueRcf_SetTrace trace = RtcDueRcf::clock.getSetTrace();
+    assert(trace[trace.size() - 1].source == RtcDueRcf_SetTrace::DST_RTC_REQUEST);
+    log.print("  Set trace: ");
+    log.println(trace);
+  }
+  delay(100);
+}
+
+static void testSetTimeAligned(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // Pretend a reference, whose second began 300ms ago.
+  const std::time_t utc = 1654077600; // 1st of June 2022 10:00:00h UTC
+  const uint32_t referenceMicros = micros() - 300000;
+  assert(RtcDueRcf::clock.setTimeAligned(utc, 300000));
+  assert(RtcDueRcf::clock.isCommitted(RtcDueRcf::clock.getSetTimeTicket()));
+
+  delay(1200); // Next second interrupt.
+  int32_t error;
+  assert(RtcDueRcf::clock.getAlignmentError(error));
+  log.print("  Alignment error: ");
+  log.print(error);
+  log.println("us");
+  assert(error > -5000 && error < 5000);
+
+  // The RTC time including the microseconds follows the reference.
+  timespec rtcTime;
+  const uint32_t now = micros();
+  assert(RtcDueRcf::clock.getTimeWithMicros(rtcTime));
+  const int32_t diff = static_cast<int32_t>((rtcTime.tv_sec - utc) * 1000000 + rtcTime.tv_nsec / 1000
+      - (now - referenceMicros));
+  assert(diff > -5000 && diff < 5000);
+
+  // A daylight savings request is pending, when setTimeAligned() takes
+  // over the acknowledge. The aligned time supersedes it.
+  {
+    TM stime;
+    makeCETdstBeginTime(stime, 58, 59, 1, 0);
+    assert(RtcDueRcf::clock.setTime_(stime));
+    waitForCommit(RtcDueRcf::clock.getSetTimeTicket());
+    // The daylight savings check requests the RTC update upon 1:59:59h.
+    const uint32_t start = millis();
+    while((RTC->RTC_CR & RTC_CR_UPDTIM) != RTC_CR_UPDTIM) {
+      assert(millis() - start < 2500);
+    }
+    const uint32_t supersededDst = RtcDueRcf::clock.getSupersededDstCount();
+    assert(RtcDueRcf::clock.setTimeAligned(utc, 0));
+    assert(RtcDueRcf::clock.getSupersededDstCount() == supersededDst + 1);
+
+    // The time is not frozen at the daylight savings adjustment.
+    delay(1200);
+    const std::time_t first = RtcDueRcf::clock.getUtcTimestamp();
+    assert(first > utc && first < utc + 4);
+    delay(1000);
+    const std::time_t second = RtcDueRcf::clock.getUtcTimestamp();
+    assert(second == first + 1 || second == first + 2);
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.readFromRtc();
+    assert(rtcTime.rtc12hrsMode() && rtcTime.tm_hour() == 12 && rtcTime.tm_min() == 0);
+  }
+
+  // Out of range.
+  assert(not RtcDueRcf::clock.setTimeAligned(utc, 1000000));
+  delay(100);
+}
+
 static void test12hourRepresentation(Stream& log, TM& tm) {
   log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
 
@@ -359,6 +882,62 @@ public:
   }
 };
 
+static void testTransaction(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  constexpr uint8_t X = RtcDueRcf_Alarm::INVALID_VALUE;
+
+  AlarmReceiver alarmReceiver(log);
+  // The previous alarm would match 2 seconds after the new time.
+  assert(RtcDueRcf::clock.setAlarm(RtcDueRcf_Alarm(2, 0, 8, X, X)));
+
+  TM stime(0, 0, 8, 1, 5, TM::make_tm_year(2022), -1);
+  const RtcDueRcf_Alarm salarm(4, 0, 8, X, X);
+  RtcDueRcf_Transaction transaction;
+  assert(transaction.setTime(stime));
+  assert(transaction.setAlarm(salarm));
+
+  TM expectedAlarm(4, 0, 8, 1, 5, TM::make_tm_year(2022), -1);
+  std::mktime(&expectedAlarm);
+  alarmReceiver.setExpectedAlarms(1, &expectedAlarm);
+  assert(RtcDueRcf::clock.commit(transaction));
+  waitForCommit(RtcDueRcf::clock.getSetTimeTicket());
+
+  RtcDueRcf_Alarm ralarm;
+  assert(RtcDueRcf::clock.getAlarm(ralarm));
+  assert(ralarm == salarm);
+
+  // Only the new alarm appears.
+  delay(5500);
+  alarmReceiver.checkAndResetAppearedAlarms();
+  RtcDueRcf::clock.clearAlarm();
+
+  // A setTime() before the RTC update supersedes the staged time, but
+  // the staged alarm is carried forward.
+  {
+    const uint32_t superseded = RtcDueRcf::clock.getSupersededCount();
+    RtcDueRcf_Transaction timeAndAlarm;
+    assert(timeAndAlarm.setTime(stime));
+    assert(timeAndAlarm.setAlarm(salarm));
+    alarmReceiver.setExpectedAlarms(1, &expectedAlarm);
+    assert(RtcDueRcf::clock.commit(timeAndAlarm));
+    TM ltime(2, 0, 8, 1, 5, TM::make_tm_year(2022), -1);
+    assert(RtcDueRcf::clock.setTime(ltime));
+    waitForCommit(RtcDueRcf::clock.getSetTimeTicket());
+    assert(RtcDueRcf::clock.getSupersededCount() == superseded + 1);
+
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.readFromRtc();
+    assert(rtcTime.tm_hour() == 8 && rtcTime.tm_min() == 0 && rtcTime.tm_sec() == 2);
+    assert(RtcDueRcf::clock.getAlarm(ralarm));
+    assert(ralarm == salarm);
+
+    delay(3500);
+    alarmReceiver.checkAndResetAppearedAlarms();
+    RtcDueRcf::clock.clearAlarm();
+  }
+  delay(100);
+}
+
 static void testAlarm(Stream& log, TM& stime, const RtcDueRcf_Alarm& salarm,
     uint32_t msecRuntimeAfterSetByLocalTime) {
   log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
@@ -432,6 +1011,13 @@ static void testAlarmReadWrite(Stream& log) {
   // Read alarm in non daylight savings period
   assert(RtcDueRcf::clock.getAlarm(ralarm));
   assert(salarm == ralarm);
+
+  // Invalid alarm must be rejected and leave the alarm unchanged.
+  RtcDueRcf_Alarm invalidAlarm;
+  invalidAlarm.setHour(24);
+  assert(not RtcDueRcf::clock.setAlarm(invalidAlarm));
+  assert(RtcDueRcf::clock.getAlarm(ralarm));
+  assert(salarm == ralarm);
 }
 
 static void testAlarmHourMode(Stream& log, const int (&tm_mon)[2], int hour) {
@@ -544,6 +1130,939 @@ void test_toTimeStamp(Stream& log) {
   test_toTimestamp(time);
 }
 
+static void checkBcdCodecTime(const uint8_t hour, const uint8_t minute, const uint8_t second,
+    const uint32_t mode) {
+  const uint32_t timeReg = RTC_BcdCodecArithmetic.timeToTimeReg(hour, minute, second, mode);
+  assert(timeReg == RTC_BcdCodecLookupTable.timeToTimeReg(hour, minute, second, mode));
+
+  for(uint32_t regMode = 0; regMode < 2; regMode++) {
+    const uint32_t reg = RTC_BcdCodecArithmetic.timeToTimeReg(hour, minute, second, regMode);
+    uint8_t a[4]; uint8_t b[4];
+    RTC_BcdCodecArithmetic.timeRegToTime(reg, nullptr, &a[0], &a[1], &a[2], regMode);
+    RTC_BcdCodecLookupTable.timeRegToTime(reg, nullptr, &b[0], &b[1], &b[2], regMode);
+    assert(a[0] == hour && a[0] == b[0] && a[1] == b[1] && a[2] == b[2]);
+    RTC_BcdCodecArithmetic.timeRegToTime(reg, &a[3], &a[0], nullptr, nullptr, regMode);
+    RTC_BcdCodecLookupTable.timeRegToTime(reg, &b[3], &b[0], nullptr, nullptr, regMode);
+    assert(a[0] == b[0] && a[3] == b[3]);
+  }
+}
+
+static void test_bcdCodec(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // Both codecs must produce the same results for all valid values.
+  for(uint32_t mode = 0; mode < 2; mode++) {
+    for(uint8_t hour = 0; hour < 24; hour++) {
+      for(uint8_t minute = 0; minute < 60; minute++) {
+        for(uint8_t second = 0; second < 60; second++) {
+          checkBcdCodecTime(hour, minute, second, mode);
+        }
+      }
+    }
+  }
+
+  for(uint16_t year = 1900; year < 2100; year++) {
+    for(uint8_t month = 1; month <= 12; month++) {
+      for(uint8_t day = 1; day <= 31; day++) {
+        const uint8_t week = (day % 7) + 1;
+        const uint32_t calReg = RTC_BcdCodecArithmetic.dateToCalReg(year, month, day, week);
+        assert(calReg == RTC_BcdCodecLookupTable.dateToCalReg(year, month, day, week));
+        uint16_t y; uint8_t m; uint8_t d; uint8_t w;
+        RTC_BcdCodecLookupTable.calRegToDate(calReg, &y, &m, &d, &w);
+        assert(y == year && m == month && d == day && w == week);
+      }
+    }
+  }
+
+  assert(RTC_BcdCodecLookupTable.timeToTimeReg(24, 0, 0, 0) == RTC_INVALID_TIME_REG);
+  assert(RTC_BcdCodecLookupTable.timeToTimeReg(0, 60, 0, 1) == RTC_INVALID_TIME_REG);
+  assert(RTC_BcdCodecLookupTable.dateToCalReg(2000, 13, 1, 1) == RTC_INVALID_CAL_REG);
+
+  // Compare execution time. The decoders are fed with register contents,
+  // that the RTC can produce: Times spread over the day in both hour
+  // modes and dates of the century.
+  constexpr uint32_t N = 24 * 60;
+  static uint32_t timeRegs[N];
+  static uint32_t calRegs[N];
+  for(uint32_t n = 0; n < N; n++) {
+    const uint32_t t = (n * 60 + n % 60) % 86400;
+    timeRegs[n] = RTC_BcdCodecArithmetic.timeToTimeReg(t / 3600, (t / 60) % 60, t % 60, n & 1);
+    calRegs[n] = RTC_BcdCodecArithmetic.dateToCalReg(2000 + (n % 100), (n % 12) + 1, (n % 28) + 1, (n % 7) + 1);
+    assert(timeRegs[n] != RTC_INVALID_TIME_REG && calRegs[n] != RTC_INVALID_CAL_REG);
+  }
+  const RtcBcdCodec* const codecs[] = {&RTC_BcdCodecArithmetic, &RTC_BcdCodecLookupTable};
+  const char* const names[] = {"arithmetic", "lookup table"};
+  startCycleCounter();
+  for(size_t i = 0; i < 2; i++) {
+    const RtcBcdCodec& codec = *codecs[i];
+    volatile uint32_t sink = 0;
+    uint8_t ampm; uint8_t hour; uint8_t minute; uint8_t second;
+    uint16_t year; uint8_t month; uint8_t day; uint8_t week;
+
+    log.print("bcd codec "); log.println(names[i]);
+
+    uint32_t start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      const uint32_t t = (n * 60 + n % 60) % 86400;
+      sink = codec.timeToTimeReg(t / 3600, (t / 60) % 60, t % 60, n & 1);
+    }
+    logCycles(log, "  timeToTimeReg", cycleCount() - start, N);
+
+    start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      codec.timeRegToTime(timeRegs[n], nullptr, &hour, &minute, &second, n & 1);
+      sink = hour;
+    }
+    logCycles(log, "  timeRegToTime", cycleCount() - start, N);
+
+    start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      codec.timeRegToTime(timeRegs[n], &ampm, &hour, nullptr, nullptr, n & 1);
+      sink = hour;
+    }
+    logCycles(log, "  timeRegToTime (AM/PM)", cycleCount() - start, N);
+
+    start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      sink = codec.dateToCalReg(2000 + (n % 100), (n % 12) + 1, (n % 28) + 1, (n % 7) + 1);
+    }
+    logCycles(log, "  dateToCalReg", cycleCount() - start, N);
+
+    start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      codec.calRegToDate(calRegs[n], &year, &month, &day, &week);
+      sink = year;
+    }
+    logCycles(log, "  calRegToDate", cycleCount() - start, N);
+    (void)sink;
+  }
+  delay(100);
+}
+
+template<typename RTC_REGS> void checkConstexprRegs(uint16_t year, uint8_t month, uint8_t day,
+    uint8_t hour, uint8_t minute, uint8_t second, uint8_t week, uint32_t rtc12HrsMode) {
+  assert(RTC_REGS::timeReg == RTC_TimeToTimeReg(hour, minute, second, rtc12HrsMode));
+  assert(RTC_REGS::calReg == RTC_DateToCalReg(year, month, day, week));
+  assert(RTC_REGS::rtc12HrsMode == rtc12HrsMode);
+}
+
+static void test_constexprRegs(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // 1st of January 2000 was a Saturday.
+  static_assert(RtcRegs<2000, 1, 1, 0, 0, 0>::calReg == 0x01E10020, "");
+  static_assert(RtcRegs<2016, 3, 27, 1, 59, 50>::timeReg == 0x00015950, "");
+
+  checkConstexprRegs<RtcRegs<2000, 1, 1, 0, 0, 0>>(2000, 1, 1, 0, 0, 0, 7, 0);
+  checkConstexprRegs<RtcRegs<2016, 3, 27, 1, 59, 50>>(2016, 3, 27, 1, 59, 50, 1, 0);
+  checkConstexprRegs<RtcRegs<2016, 10, 30, 2, 59, 50, true>>(2016, 10, 30, 2, 59, 50, 1, 1);
+  checkConstexprRegs<RtcRegs<2024, 2, 29, 0, 0, 0, true>>(2024, 2, 29, 0, 0, 0, 5, 1);
+  checkConstexprRegs<RtcRegs<2024, 12, 31, 12, 30, 0, true>>(2024, 12, 31, 12, 30, 0, 3, 1);
+  checkConstexprRegs<RtcRegs<2099, 12, 31, 23, 59, 59, true>>(2099, 12, 31, 23, 59, 59, 5, 1);
+
+  constexpr uint8_t X = RtcDueRcf_Alarm::INVALID_VALUE;
+  typedef RtcAlarmRegs<13, X, 40, X, 24> Alarm;
+  assert(Alarm::timeAlarmReg24 == (RTC_TimeToTimeReg(13, 0, 40, 0) | RTC_TIMALR_HOUREN | RTC_TIMALR_SECEN));
+  assert(Alarm::timeAlarmReg12 == (RTC_TimeToTimeReg(13, 0, 40, 1) | RTC_TIMALR_HOUREN | RTC_TIMALR_SECEN));
+  assert(Alarm::calAlarmReg == (RTC_DateToCalReg(0, 1, 24, 0) | RTC_CALALR_DATEEN));
+}
+
+static void test_regsToTimeStamp(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  RtcDueRcf::tzset(TZ::CET);
+
+  // Run through 2000..2037 in odd steps to hit all hours, both hour modes
+  // and the days around the daylight savings transitions. 2037 is the
+  // limit of a 32 bit std::time_t.
+  constexpr std::time_t STEP = 3 * 24 * 3600 + 3601 + 7;
+  constexpr std::time_t BEGIN = 946684800;   // 2000-01-01 00:00:00 UTC
+  constexpr std::time_t END = 2145916800;    // 2038-01-01 00:00:00 UTC
+  for(std::time_t utc = BEGIN; utc < END; utc += STEP) {
+    std::tm time;
+    localtime_r(&utc, &time);
+    const RtcTimeSnapshot regs = {
+        RTC_TimeToTimeReg(time.tm_hour, time.tm_min, time.tm_sec, time.tm_isdst > 0),
+        RTC_DateToCalReg(time.tm_year + 1900, time.tm_mon + 1, time.tm_mday, time.tm_wday + 1),
+        static_cast<uint32_t>(time.tm_isdst > 0 ? RTC_MR_HRMOD : 0)
+    };
+    const Sam3XA::RtcSnapshot snapshot(regs);
+    assert(snapshot.utcTimeStamp() == utc);
+  }
+
+  // Compile time registers.
+  typedef RtcRegs<2024, 2, 29, 12, 30, 15, true> Regs;
+  const RtcTimeSnapshot regs = {Regs::timeReg, Regs::calReg, Regs::rtc12HrsMode};
+  assert(Sam3XA::RtcSnapshot(regs).localTimeStamp() == 1709209815);
+  assert(Sam3XA::RtcSnapshot(regs).utcTimeStamp() == 1709209815 - 2 * 3600);
+  delay(100);
+}
+
+static void checkUtcToRtcTime(const std::time_t utc) {
+  std::tm time;
+  localtime_r(&utc, &time);
+  Sam3XA::RtcTime expected;
+  expected.set(time);
+
+  Sam3XA::RtcTime rtcTime;
+  rtcTime.setUtc(utc);
+  assert(rtcTime == expected);
+}
+
+static void test_utcToRtcTime(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // North and south hemisphere.
+  static const char* const timezones[] = {TZ::CET, TZ::NZST};
+  for(const char* const timezone : timezones) {
+    RtcDueRcf::tzset(timezone);
+    constexpr std::time_t STEP = 5 * 24 * 3600 + 3601 + 7;
+    constexpr std::time_t BEGIN = 946684800;   // 2000-01-01 00:00:00 UTC
+    constexpr std::time_t END = 2145916800;    // 2038-01-01 00:00:00 UTC
+    for(std::time_t utc = BEGIN; utc < END; utc += STEP) {
+      checkUtcToRtcTime(utc);
+    }
+  }
+
+  // Around the CET transitions of 2016.
+  RtcDueRcf::tzset(TZ::CET);
+  for(std::time_t utc = 1459040400 - 2; utc < 1459040400 + 2; utc++) {
+    checkUtcToRtcTime(utc); // 2016-03-27 01:00:00 UTC
+  }
+  for(std::time_t utc = 1477789200 - 2; utc < 1477789200 + 2; utc++) {
+    checkUtcToRtcTime(utc); // 2016-10-30 01:00:00 UTC
+  }
+  delay(100);
+}
+
+/**
+ * Simulate the RTC daylight savings check with the transition cache for
+ * the local time of utc. The rules are evaluated in any case, in order
+ * to verify that the cache doesn't suppress a request.
+ *
+ * @return true, if the rules would have been evaluated by the RTC interrupt.
+ */
+static bool checkDstTransitionCache(Sam3XA::RtcDstTransitionCache& cache, const std::time_t utc,
+    uint8_t& rtc12hrsMode) {
+  Sam3XA::RtcTime rtcTime;
+  rtcTime.set(utc - Sam3XA::RtcTimeZone::rules().rule[rtc12hrsMode].offset, rtc12hrsMode);
+
+  const bool isCheckDue = cache.isCheckDue(rtcTime, 0);
+  Sam3XA::RtcTime dueTime;
+  const bool request = dueTime.isDstRtcRequest(rtcTime);
+  assert(isCheckDue || not request);
+  if(request) {
+    // Commit the daylight savings request.
+    rtc12hrsMode = dueTime.rtc12hrsMode();
+    cache.invalidate();
+  } else if(isCheckDue) {
+    cache.update(rtcTime, 0);
+  }
+  return isCheckDue;
+}
+
+static void test_dstTransitionCache(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // North and south hemisphere and no daylight savings.
+  static const char* const timezones[] = {TZ::CET, TZ::NZST, TZ::UTC};
+  for(const char* const timezone : timezones) {
+    RtcDueRcf::tzset(timezone);
+    constexpr std::time_t STEP = 3600 + 7;
+    constexpr std::time_t BEGIN = 1451606400;  // 2016-01-01 00:00:00 UTC
+    constexpr std::time_t END = 1546300800;    // 2019-01-01 00:00:00 UTC
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.setUtc(BEGIN);
+    uint8_t rtc12hrsMode = rtcTime.rtc12hrsMode();
+    Sam3XA::RtcDstTransitionCache cache;
+    size_t checks = 0;
+    size_t transitions = 0;
+    for(std::time_t utc = BEGIN; utc < END; utc += STEP) {
+      const uint8_t mode = rtc12hrsMode;
+      checks += checkDstTransitionCache(cache, utc, rtc12hrsMode);
+      transitions += (mode != rtc12hrsMode);
+    }
+    // The initial check, and two checks per transition: One that
+    // requests the transition and one after the commit.
+    assert(transitions == (Sam3XA::RtcTimeZone::rules().daylight ? 6 : 0));
+    assert(checks <= 1 + 2 * transitions);
+  }
+
+  // Second by second around the CET transitions of 2016.
+  RtcDueRcf::tzset(TZ::CET);
+  static const std::time_t transitions[] = {
+      1459040400, // 2016-03-27 01:00:00 UTC
+      1477789200, // 2016-10-30 01:00:00 UTC
+  };
+  for(const std::time_t transition : transitions) {
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.setUtc(transition - 10);
+    uint8_t rtc12hrsMode = rtcTime.rtc12hrsMode();
+    Sam3XA::RtcDstTransitionCache cache;
+    size_t checks = 0;
+    for(std::time_t utc = transition - 10; utc < transition + 10; utc++) {
+      checks += checkDstTransitionCache(cache, utc, rtc12hrsMode);
+    }
+    assert(rtc12hrsMode != rtcTime.rtc12hrsMode());
+    assert(checks == 3);
+  }
+
+  // Execution time of the check once a second.
+  {
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.setUtc(1459040400 - 3600);
+    Sam3XA::RtcDstTransitionCache cache;
+    cache.update(rtcTime, 0);
+
+    constexpr uint32_t N = 100;
+    volatile bool sink = false;
+    uint32_t start = cycleCount();
+    for(uint32_t i = 0; i < N; i++) {
+      Sam3XA::RtcTime dueTime;
+      sink = dueTime.isDstRtcRequest(rtcTime);
+    }
+    logCycles(log, "  daylight savings rules", cycleCount() - start, N);
+    start = cycleCount();
+    for(uint32_t i = 0; i < N; i++) {
+      sink = cache.isCheckDue(rtcTime, 0);
+    }
+    logCycles(log, "  transition cache", cycleCount() - start, N);
+    (void)sink;
+  }
+  delay(100);
+}
+
+/**
+ * RTC register block that runs second by second. The interrupt runs
+ * the daylight savings check and the wake up selection of
+ * RtcDueRcf_DstChecker() and RtcDueRcf_SelectWakeup() against it.
+ */
+struct SimulatedDstRtc {
+  Rtc rtc = {};
+  Sam3XA::RtcTime rtcTime;
+  Sam3XA::RtcDstTransitionCache cache;
+  Sam3XA::RtcTime dueTime;
+  bool request = false;
+  size_t wakeups = 0;
+
+  SimulatedDstRtc(const std::time_t utc) {
+    rtcTime.setUtc(utc);
+    writeRegs();
+    selectWakeup(RTC_WAKEUP_SECOND);
+  }
+
+  void writeRegs() {
+    rtc.RTC_TIMR = RTC_TimeToTimeReg(rtcTime.hour(), rtcTime.minute(), rtcTime.second(), rtcTime.rtc12hrsMode());
+    rtc.RTC_CALR = RTC_DateToCalReg(rtcTime.year(), rtcTime.month(), rtcTime.day(), rtcTime.day_of_week());
+    rtc.RTC_MR = rtcTime.rtc12hrsMode() ? RTC_MR_HRMOD : 0;
+  }
+
+  void selectWakeup(const uint32_t wakeup) {
+    RTC_SelectWakeup(&rtc, wakeup);
+    // The interrupt mask register follows the enable and disable registers.
+    rtc.RTC_IMR = (rtc.RTC_IMR | rtc.RTC_IER) & ~rtc.RTC_IDR;
+    rtc.RTC_IER = 0;
+    rtc.RTC_IDR = 0;
+  }
+
+  /**
+   * The RTC counts, or it commits the request of the previous second.
+   * Then the interrupt is serviced, if one of the events is enabled.
+   */
+  void tick(const bool eventDriven) {
+    if(request) {
+      rtcTime = dueTime;
+      request = false;
+      // As RtcDueRcf_AckUpdHandler() does upon the commit.
+      cache.invalidate();
+      selectWakeup(RTC_WAKEUP_SECOND);
+    } else {
+      rtcTime = rtcTime + 1;
+    }
+    writeRegs();
+
+    const uint32_t timeEventSel = rtc.RTC_CR & RTC_CR_TIMEVSEL_Msk;
+    const bool timeEvent = rtcTime.second() == 0
+        && (timeEventSel == RTC_CR_TIMEVSEL_MINUTE || rtcTime.minute() == 0);
+    const uint32_t status = (RTC_SR_SEC | (timeEvent ? RTC_SR_TIMEV : 0)) & rtc.RTC_IMR;
+    if(status) {
+      wakeups++;
+      Sam3XA::RtcTime readTime;
+      readTime.set(Sam3XA::RtcSnapshot({rtc.RTC_TIMR, rtc.RTC_CALR, rtc.RTC_MR}));
+      if(status & RTC_SR_SEC) {
+        request = cache.check(readTime, 0, dueTime);
+      }
+      if(eventDriven) {
+        // A pending request needs the second interrupt.
+        selectWakeup(request ? RTC_WAKEUP_SECOND : cache.selectWakeup(readTime, 0));
+      }
+    }
+  }
+};
+
+/**
+ * Let a simulated RTC with event driven daylight savings check run
+ * second by second across the CET transitions of 2016, along with one
+ * that is checked once a second.
+ */
+static void test_eventDrivenDstCheck(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  RtcDueRcf::tzset(TZ::CET);
+  static const std::time_t transitions[] = {
+      1459040400, // 2016-03-27 01:00:00 UTC
+      1477789200, // 2016-10-30 01:00:00 UTC
+  };
+  for(const std::time_t transition : transitions) {
+    const std::time_t BEGIN = transition - 2 * 24 * 3600 - 1234;
+    const std::time_t END = transition + 24 * 3600;
+    SimulatedDstRtc eventDriven(BEGIN);
+    SimulatedDstRtc everySecond(BEGIN);
+    const uint32_t mode = everySecond.rtc.RTC_MR;
+    for(std::time_t utc = BEGIN + 1; utc < END; utc++) {
+      eventDriven.tick(true);
+      everySecond.tick(false);
+      // The hour mode switches at exactly the same second.
+      assert(eventDriven.rtc.RTC_TIMR == everySecond.rtc.RTC_TIMR);
+      assert(eventDriven.rtc.RTC_CALR == everySecond.rtc.RTC_CALR);
+      assert(eventDriven.rtc.RTC_MR == everySecond.rtc.RTC_MR);
+    }
+    assert(eventDriven.rtc.RTC_MR != mode);
+    // Hour changes, the minute changes of the last hour and the seconds
+    // of the last minute before the transition.
+    assert(everySecond.wakeups == static_cast<size_t>(END - BEGIN - 1));
+    assert(eventDriven.wakeups < 3 * 24 + 2 * 60 + 10);
+  }
+  delay(100);
+}
+
+/**
+ * Compare rules that have been parsed at compile time against the
+ * ones of newlib's parser.
+ */
+static void checkTimeZone(const RtcDueRcf_TimeZone& timeZone) {
+  setenv("TZ", timeZone.tz, true);
+  ::tzset();
+  const __tzinfo_type * const tz = __gettzinfo ();
+  assert(timeZone.valid);
+  assert(timeZone.daylight == (_daylight != 0));
+  assert(timeZone.rule[0].offset == tz->__tzrule[0].offset);
+  if(timeZone.daylight) {
+    for(size_t i = 0; i < 2; i++) {
+      const RtcDueRcf_TzRule& rule = timeZone.rule[i];
+      const __tzrule_struct& expected = tz->__tzrule[i];
+      assert(rule.ch == expected.ch && rule.m == expected.m && rule.n == expected.n
+          && rule.d == expected.d && rule.s == expected.s && rule.offset == expected.offset);
+    }
+  }
+}
+
+static void test_timeZoneParser(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // Parsed at compile time.
+  constexpr RtcDueRcf_TimeZone CET = TZ::RULES::CET;
+  static_assert(CET.valid && CET.daylight, "CET has daylight savings.");
+  static_assert(CET.rule[0].ch == 'M' && CET.rule[0].m == 3 && CET.rule[0].n == 5 && CET.rule[0].d == 0
+      && CET.rule[0].s == 2 * 3600 && CET.rule[0].offset == -3600, "CET begin of daylight savings.");
+  static_assert(CET.rule[1].ch == 'M' && CET.rule[1].m == 10 && CET.rule[1].n == 5 && CET.rule[1].d == 0
+      && CET.rule[1].s == 3 * 3600 && CET.rule[1].offset == -7200, "CET end of daylight savings.");
+  static_assert(TZ::RULES::NZST.rule[0].s == 2 * 3600, "Default transition time.");
+  static_assert(TZ::RULES::NZST.rule[1].offset == -13 * 3600, "NZST daylight savings offset.");
+  static_assert(not TZ::RULES::EST.daylight && TZ::RULES::EST.rule[0].offset == 5 * 3600,
+      "EST has no daylight savings.");
+
+  // Default daylight savings offset and default rules.
+  constexpr RtcDueRcf_TimeZone EST5EDT = RtcDueRcf_TimeZone::parse("EST5EDT");
+  static_assert(EST5EDT.daylight && EST5EDT.rule[0].offset == 5 * 3600 && EST5EDT.rule[1].offset == 4 * 3600,
+      "One hour ahead of the standard time.");
+  static_assert(EST5EDT.rule[0].m == 3 && EST5EDT.rule[0].n == 2 && EST5EDT.rule[1].m == 11
+      && EST5EDT.rule[1].n == 1, "US rules.");
+
+  // Transition time with minutes and day of year rules.
+  constexpr RtcDueRcf_TimeZone CUSTOM = RtcDueRcf_TimeZone::parse(":XYZ-5:30XYZDST,J60/1:30,300");
+  static_assert(CUSTOM.valid && CUSTOM.rule[0].offset == -(5 * 3600 + 30 * 60), "Offset with minutes.");
+  static_assert(CUSTOM.rule[0].ch == 'J' && CUSTOM.rule[0].d == 60 && CUSTOM.rule[0].s == 5400,
+      "Julian day rule.");
+  static_assert(CUSTOM.rule[1].ch == 'D' && CUSTOM.rule[1].d == 300 && CUSTOM.rule[1].s == 2 * 3600,
+      "Zero based day rule.");
+
+  static_assert(not RtcDueRcf_TimeZone::parse("-1:00").valid, "Name is missing.");
+  static_assert(not RtcDueRcf_TimeZone::parse("CET").valid, "Offset is missing.");
+  static_assert(not RtcDueRcf_TimeZone::parse("CET-1CEST,M13.5.0,M10.5.0").valid, "Month out of range.");
+  static_assert(not RtcDueRcf_TimeZone::parse("CET-1CEST,M3.5,M10.5.0").valid, "Day of week is missing.");
+
+  // Same result as newlib at run time.
+  static const RtcDueRcf_TimeZone* const timeZones[] = {
+      &TZ::RULES::UTC, &TZ::RULES::UK, &TZ::RULES::CET, &TZ::RULES::EST, &TZ::RULES::ET,
+      &TZ::RULES::CST, &TZ::RULES::CT, &TZ::RULES::MST, &TZ::RULES::MT, &TZ::RULES::PST,
+      &TZ::RULES::PT, &TZ::RULES::NZST,
+  };
+  for(const RtcDueRcf_TimeZone* const timeZone : timeZones) {
+    checkTimeZone(*timeZone);
+  }
+
+  // The daylight savings logic works with the passed rules.
+  RtcDueRcf::tzset(TZ::RULES::NZST);
+  assert(Sam3XA::RtcTimeZone::rules().rule[0].m == 9);
+  RtcDueRcf::tzset(TZ::CET);
+  assert(Sam3XA::RtcTimeZone::rules().rule[0].m == 3);
+
+  // A string the rules can't be parsed from leaves both time zones unchanged.
+  assert(not RtcDueRcf::tzset("<+03>-3"));
+  assert(strcmp(getenv("TZ"), TZ::CET) == 0);
+  assert(Sam3XA::RtcTimeZone::rules().rule[0].m == 3);
+
+  constexpr uint32_t N = 10;
+  uint32_t start = cycleCount();
+  for(uint32_t i = 0; i < N; i++) {
+    RtcDueRcf::tzset(TZ::CET);
+  }
+  logCycles(log, "  tzset(TZ::CET)", cycleCount() - start, N);
+  start = cycleCount();
+  for(uint32_t i = 0; i < N; i++) {
+    RtcDueRcf::tzset(TZ::RULES::CET);
+  }
+  logCycles(log, "  tzset(TZ::RULES::CET)", cycleCount() - start, N);
+  delay(100);
+}
+
+static void checkArithmeticOperators(const std::time_t timeStamp, const std::time_t sec) {
+  Sam3XA::RtcTime rtcTime;
+  rtcTime.set(timeStamp, 1);
+
+  // Reference: Round trip via the unix time stamp.
+  Sam3XA::RtcTime expected;
+  expected.set(timeStamp + sec, 1);
+  assert(rtcTime + sec == expected);
+  expected.set(timeStamp - sec, 1);
+  assert(rtcTime - sec == expected);
+}
+
+/**
+ * Compare the conversion of a zone view against newlib's localtime_r()
+ * with the zone set as TZ environment variable.
+ */
+static void checkZoneView(Sam3XA::RtcZoneView& view, const std::time_t utc) {
+  Sam3XA::RtcTime rtcTime;
+  view.toLocal(utc, rtcTime);
+  std::tm time;
+  rtcTime.get(time);
+  std::tm expected;
+  localtime_r(&utc, &expected);
+  assert(time.tm_year == expected.tm_year && time.tm_mon == expected.tm_mon
+      && time.tm_mday == expected.tm_mday && time.tm_wday == expected.tm_wday);
+  assert(time.tm_hour == expected.tm_hour && time.tm_min == expected.tm_min
+      && time.tm_sec == expected.tm_sec && time.tm_isdst == expected.tm_isdst);
+}
+
+static void test_zoneViews(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // North and south hemisphere, negative and positive offsets and no
+  // daylight savings.
+  static constexpr RtcDueRcf_TimeZone EST5EDT = RtcDueRcf_TimeZone::parse("EST5EDT,M3.2.0,M11.1.0");
+  static constexpr RtcDueRcf_TimeZone GMT0BST = RtcDueRcf_TimeZone::parse("GMT0BST,M3.5.0/1,M10.5.0");
+  static const RtcDueRcf_TimeZone* const timeZones[] = {
+      &TZ::RULES::CET, &TZ::RULES::NZST, &EST5EDT, &GMT0BST, &TZ::RULES::EST,
+  };
+  Sam3XA::RtcZoneView views[sizeof(timeZones) / sizeof(timeZones[0])];
+  for(size_t i = 0; i < sizeof(timeZones) / sizeof(timeZones[0]); i++) {
+    views[i].set(*timeZones[i]);
+    setenv("TZ", timeZones[i]->tz, true);
+    ::tzset();
+
+    // The century with a stride that hits all times of the day.
+    constexpr std::time_t BEGIN = 946684800;  // 2000-01-01 00:00:00 UTC
+    constexpr std::time_t END = 2147483647;   // 2038-01-19 03:14:07 UTC
+    for(std::time_t utc = BEGIN; utc < END; utc += 3 * 24 * 3600 + 3637) {
+      checkZoneView(views[i], utc);
+    }
+
+    // Each hour of 2016 including the second before and after, where
+    // all transitions are.
+    constexpr std::time_t BEGIN_2016 = 1451606400;  // 2016-01-01 00:00:00 UTC
+    constexpr std::time_t END_2016 = 1483228800;    // 2017-01-01 00:00:00 UTC
+    for(std::time_t utc = BEGIN_2016; utc < END_2016; utc += 3600) {
+      checkZoneView(views[i], utc - 1);
+      checkZoneView(views[i], utc);
+      checkZoneView(views[i], utc + 1);
+    }
+  }
+  RtcDueRcf::tzset(TZ::CET);
+
+  // The conversion of the registered zones from one RTC read. The
+  // daylight savings period is cached, so the cost per zone doesn't
+  // depend on the number of zones.
+  constexpr std::time_t UTC = 1459040400;  // 2016-03-27 01:00:00 UTC
+  constexpr uint32_t N = 100;
+  Sam3XA::RtcTime rtcTime;
+  uint32_t start = cycleCount();
+  for(uint32_t i = 0; i < N; i++) {
+    views[0].toLocal(UTC + i, rtcTime);
+  }
+  logCycles(log, "  RtcZoneView::toLocal()", cycleCount() - start, N);
+  start = cycleCount();
+  for(uint32_t i = 0; i < N; i++) {
+    for(Sam3XA::RtcZoneView& view : views) {
+      view.toLocal(UTC + i, rtcTime);
+    }
+  }
+  logCycles(log, "  RtcZoneView::toLocal() 5 zones", cycleCount() - start, N);
+  delay(100);
+}
+
+static void test_tzTable(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // Europe/Moscow 2010..2015, generated by extras/host/RtcDueRcf_TzTableGen.py.
+  // Daylight savings in 2010, permanent +4:00h from 2011, back to +3:00h in 2014.
+  static constexpr RtcDueRcf_TzTable::Type types[] = {{-10800, 0}, {-14400, 1}, {-14400, 0}};
+  static constexpr RtcDueRcf_TzTable::Block blocks[] = {{1269730800, 0}};
+  static constexpr uint8_t data[] = {0x01, 0x80, 0xCA, 0x98, 0x01, 0x82, 0xAE, 0x67, 0xA0, 0xAE, 0x98, 0x07};
+  static constexpr RtcDueRcf_TzTable MOSCOW = {"Europe/Moscow", types, blocks, 1, data, 4, 0};
+
+  static const struct {
+    std::time_t utc;
+    int32_t offset;
+    uint8_t isdst;
+    std::time_t validFrom;
+    std::time_t validUntil;
+  } expected[] = {
+    {1262304000, -10800, 0, RtcDueRcf_TzTable::TIME_MIN, 1269730800}, // 2010-01-01 00:00:00 UTC
+    {1269730799, -10800, 0, RtcDueRcf_TzTable::TIME_MIN, 1269730800},
+    {1269730800, -14400, 1, 1269730800, 1288479600}, // 2010-03-27 23:00:00 UTC
+    {1288479600, -10800, 0, 1288479600, 1301180400}, // 2010-10-30 23:00:00 UTC
+    {1301180400, -14400, 0, 1301180400, 1414274400}, // 2011-03-26 23:00:00 UTC
+    {1356998400, -14400, 0, 1301180400, 1414274400}, // 2013-01-01 00:00:00 UTC
+    {1414274400, -10800, 0, 1414274400, RtcDueRcf_TzTable::TIME_MAX}, // 2014-10-25 22:00:00 UTC
+  };
+  for(const auto& e : expected) {
+    std::time_t validFrom;
+    std::time_t validUntil;
+    const RtcDueRcf_TzTable::Type& type = MOSCOW.lookup(e.utc, validFrom, validUntil);
+    assert(type.offset == e.offset && type.isdst == e.isdst);
+    assert(validFrom == e.validFrom && validUntil == e.validUntil);
+  }
+
+  // The zone view takes the offsets from the table.
+  Sam3XA::RtcZoneView view;
+  view.set(MOSCOW);
+  Sam3XA::RtcTime rtcTime;
+  view.toLocal(1301180399, rtcTime);
+  assert(rtcTime.hour() == 1 && rtcTime.minute() == 59 && rtcTime.second() == 59 && not rtcTime.rtc12hrsMode());
+  view.toLocal(1301180400, rtcTime);
+  assert(rtcTime.hour() == 3 && rtcTime.minute() == 0 && rtcTime.second() == 0 && not rtcTime.rtc12hrsMode());
+  view.toLocal(1310000000, rtcTime); // 2011-07-07 00:53:20 UTC
+  assert(rtcTime.hour() == 4 && rtcTime.minute() == 53 && not rtcTime.rtc12hrsMode());
+
+  constexpr uint32_t N = 100;
+  std::time_t validFrom;
+  std::time_t validUntil;
+  uint32_t start = cycleCount();
+  for(uint32_t i = 0; i < N; i++) {
+    MOSCOW.lookup(1269730800 + i * 3600 * 24 * 7, validFrom, validUntil);
+  }
+  logCycles(log, "  RtcDueRcf_TzTable::lookup()", cycleCount() - start, N);
+  delay(100);
+}
+
+static void test_arithmeticOperators(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  static const std::time_t deltas[] = {0, 1, 59, 60, 3599, 3600, 7200, 43200, 86399, 86400, 31 * 86400 + 1};
+
+  // Start at 2000-01-01 00:00:00, so that the steps cross the ends of days,
+  // months, years and the 29th of February.
+  for(std::time_t timeStamp = 946684800; timeStamp < 2145916800; timeStamp += 86400 * 11 + 1801) {
+    for(const std::time_t sec : deltas) {
+      checkArithmeticOperators(timeStamp, sec);
+      checkArithmeticOperators(timeStamp - (timeStamp % 86400), sec); // midnight
+      checkArithmeticOperators(timeStamp - (timeStamp % 86400) - 1, sec); // just before midnight
+    }
+  }
+  checkArithmeticOperators(951782400, 3600); // 2000-02-29 00:00:00
+  checkArithmeticOperators(951868799, 1);    // 2000-02-29 23:59:59
+  checkArithmeticOperators(978307199, 3600); // 2000-12-31 23:59:59
+
+  {
+    constexpr uint32_t N = 1000;
+    startCycleCounter();
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.set(1477789200, 1);
+    volatile uint8_t sink = 0;
+
+    uint32_t start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      Sam3XA::RtcTime result;
+      result.set(rtcTime.toTimeStamp() - 3600, 1);
+      sink = result.hour();
+    }
+    logCycles(log, "  time stamp round trip", cycleCount() - start, N);
+
+    start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      sink = (rtcTime - 3600).hour();
+    }
+    logCycles(log, "  field carry", cycleCount() - start, N);
+    (void)sink;
+  }
+  delay(100);
+}
+
+/*
+ * Reference validation digit by digit, as described in the SAM3X data sheet.
+ */
+static bool isValidBcd(uint32_t bcd, uint32_t lo, uint32_t hi) {
+  const uint32_t tens = bcd >> 4;
+  const uint32_t ones = bcd & 0x0F;
+  return tens <= 9 && ones <= 9 && tens * 10 + ones >= lo && tens * 10 + ones <= hi;
+}
+
+static bool isValidTimeRegRef(uint32_t timeReg, uint32_t rtc12HrsMode) {
+  const uint32_t ampm = rtc12HrsMode ? RTC_TIMR_AMPM : 0;
+  return (timeReg & ~(RTC_TIMR_SEC_Msk | RTC_TIMR_MIN_Msk | RTC_TIMR_HOUR_Msk | ampm)) == 0
+      && isValidBcd(timeReg & 0x7F, 0, 59)
+      && isValidBcd((timeReg >> 8) & 0x7F, 0, 59)
+      && isValidBcd((timeReg >> 16) & 0x3F, rtc12HrsMode ? 1 : 0, rtc12HrsMode ? 12 : 23);
+}
+
+static bool isValidCalRegRef(uint32_t calReg) {
+  if((calReg & ~(RTC_CALR_CENT_Msk | RTC_CALR_YEAR_Msk | RTC_CALR_MONTH_Msk
+      | RTC_CALR_DAY_Msk | RTC_CALR_DATE_Msk)) != 0) {
+    return false;
+  }
+  const uint32_t week = (calReg >> 21) & 7;
+  if(not (isValidBcd(calReg & 0x7F, 19, 20) && isValidBcd((calReg >> 8) & 0xFF, 0, 99)
+      && isValidBcd((calReg >> 16) & 0x1F, 1, 12) && week >= 1)) {
+    return false;
+  }
+  uint16_t year; uint8_t month; uint8_t day;
+  RTC_CalRegToDate(calReg, &year, &month, &day, nullptr);
+  return isValidBcd(calReg >> 24, 1, Sam3XA::RtcRegsConstexpr::daysInMonth(year, month));
+}
+
+static void test_swarValidation(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // All encoded times and dates must be valid.
+  for(uint32_t rtc12HrsMode = 0; rtc12HrsMode < 2; rtc12HrsMode++) {
+    for(uint8_t hour = 0; hour < 24; hour++) {
+      for(uint8_t minute = 0; minute < 60; minute++) {
+        for(uint8_t second = 0; second < 60; second++) {
+          const uint32_t timeReg = RTC_TimeToTimeReg(hour, minute, second, rtc12HrsMode);
+          assert(RTC_IsValidTimeReg(timeReg, rtc12HrsMode));
+          assert(RTC_IsValidTimeAlarmReg(timeReg | RTC_TIMALR_HOUREN | RTC_TIMALR_SECEN, rtc12HrsMode));
+        }
+      }
+    }
+  }
+  for(uint16_t year = 1900; year < 2100; year++) {
+    for(uint8_t month = 1; month <= 12; month++) {
+      const uint8_t days = Sam3XA::RtcRegsConstexpr::daysInMonth(year, month);
+      for(uint8_t day = 1; day <= 31; day++) {
+        const uint32_t calReg = RTC_DateToCalReg(year, month, day, 1);
+        assert(RTC_IsValidCalReg(calReg) == (day <= days));
+      }
+    }
+  }
+  assert(not RTC_IsValidTimeReg(RTC_INVALID_TIME_REG, 0));
+  assert(not RTC_IsValidCalReg(RTC_INVALID_CAL_REG));
+  assert(RTC_IsValidCalAlarmReg(RTC_DateToCalReg(0, 2, 29, 0) | RTC_CALALR_MTHEN | RTC_CALALR_DATEEN));
+  assert(not RTC_IsValidCalAlarmReg(RTC_DateToCalReg(0, 2, 30, 0) | RTC_CALALR_DATEEN));
+  assert(not RTC_IsValidCalAlarmReg(RTC_DateToCalReg(0, 13, 1, 0) | RTC_CALALR_MTHEN));
+
+  // Pseudo random register contents, mostly restricted to the field bits.
+  uint32_t random = 1;
+  for(uint32_t n = 0; n < 1000000; n++) {
+    random = random * 1664525 + 1013904223;
+    const uint32_t rtc12HrsMode = (n >> 1) & 1;
+    const uint32_t timeReg = (n & 1) ? random & (RTC_TIMR_SEC_Msk | RTC_TIMR_MIN_Msk
+        | RTC_TIMR_HOUR_Msk | RTC_TIMR_AMPM) : random;
+    assert(RTC_IsValidTimeReg(timeReg, rtc12HrsMode) == isValidTimeRegRef(timeReg, rtc12HrsMode));
+    const uint32_t calReg = (n & 1) ? (random & (RTC_CALR_YEAR_Msk | RTC_CALR_MONTH_Msk
+        | RTC_CALR_DAY_Msk | RTC_CALR_DATE_Msk)) | (n & 4 ? 0x20 : 0x19) : random;
+    assert(RTC_IsValidCalReg(calReg) == isValidCalRegRef(calReg));
+  }
+
+  {
+    constexpr uint32_t N = 1000;
+    startCycleCounter();
+    volatile uint32_t timeReg = RtcRegs<2016, 10, 30, 2, 59, 50>::timeReg;
+    volatile uint32_t calReg = RtcRegs<2016, 10, 30, 2, 59, 50>::calReg;
+    volatile bool sink = false;
+
+    uint32_t start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      sink = isValidTimeRegRef(timeReg, 0) && isValidCalRegRef(calReg);
+    }
+    logCycles(log, "  digit by digit validation", cycleCount() - start, N);
+
+    start = cycleCount();
+    for(uint32_t n = 0; n < N; n++) {
+      sink = RTC_IsValidTimeReg(timeReg, 0) && RTC_IsValidCalReg(calReg);
+    }
+    logCycles(log, "  SWAR validation", cycleCount() - start, N);
+    (void)sink;
+  }
+  delay(100);
+}
+
+static void test_timeSeqlock(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  Sam3XA::RtcTimeSeqlock seqlock;
+  Sam3XA::RtcTime rtcTime;
+  assert(not seqlock.read(rtcTime, 0)); // Nothing published yet.
+
+  Sam3XA::RtcTime published;
+  published.set(1477789200, 1);
+  seqlock.publish(published, 5000);
+  uint32_t secondMicros;
+  assert(seqlock.read(rtcTime, secondMicros, 5000));
+  assert(rtcTime == published && secondMicros == 5000);
+  assert(seqlock.read(rtcTime, 5000 + Sam3XA::RtcTimeSeqlock::MAX_AGE_US));
+  assert(not seqlock.read(rtcTime, 5001 + Sam3XA::RtcTimeSeqlock::MAX_AGE_US)); // Outdated.
+
+  // micros() overflow
+  seqlock.publish(published, UINT32_MAX - 10);
+  assert(seqlock.read(rtcTime, 100));
+
+  seqlock.invalidate();
+  assert(not seqlock.read(rtcTime, 0));
+  delay(100);
+}
+
+static void test_boundedSnapshotRead(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+
+  // A register set, that does not change while being read. The RTC runs
+  // in 12-hrs mode, so RTC_TIMR is encoded in 12-hrs mode as well.
+  Rtc rtc = {};
+  rtc.RTC_TIMR = RtcRegs<2024, 2, 29, 23, 59, 59, true>::timeReg;
+  rtc.RTC_CALR = RtcRegs<2024, 2, 29, 23, 59, 59, true>::calReg;
+  rtc.RTC_MR = RTC_MR_HRMOD;
+
+  RtcTimeSnapshot snapshot = {0, 0, 0};
+  assert(RTC_ReadTimeSnapshot(&rtc, &snapshot, 0) == 0);
+  assert(snapshot.timr == rtc.RTC_TIMR && snapshot.calr == rtc.RTC_CALR && snapshot.mr == RTC_MR_HRMOD);
+
+  snapshot = RtcTimeSnapshot{0, 0, 0};
+  assert(RTC_ReadTimeSnapshot(&rtc, &snapshot, RTC_READ_RETRY_LIMIT) == 0);
+  assert(snapshot.timr == rtc.RTC_TIMR && snapshot.calr == rtc.RTC_CALR);
+
+  // Time only and date only.
+  uint32_t timeReg = 0;
+  uint32_t calReg = 0;
+  uint32_t rtc12HrsMode = 0;
+  assert(RTC_ReadTimeReg(&rtc, &timeReg, &rtc12HrsMode, 0) == 0);
+  assert(timeReg == rtc.RTC_TIMR && rtc12HrsMode == 1);
+  assert(RTC_ReadCalReg(&rtc, &calReg, 0) == 0);
+  assert(calReg == rtc.RTC_CALR);
+
+  // Decoding a single register delivers the same fields as the snapshot.
+  {
+    Sam3XA::RtcTime rtcTime;
+    rtcTime.set(Sam3XA::RtcSnapshot(snapshot));
+    std::tm expected;
+    rtcTime.get(expected);
+
+    Sam3XA::RtcTime partial;
+    partial.setTimeOfDay(timeReg, rtc12HrsMode);
+    partial.setDate(calReg);
+    std::tm time;
+    partial.getTimeOfDay(time);
+    partial.getDate(time);
+    assert(time.tm_hour == 23 && time.tm_min == 59 && time.tm_sec == 59 && time.tm_isdst == 1);
+    assert(time.tm_hour == expected.tm_hour && time.tm_min == expected.tm_min && time.tm_sec == expected.tm_sec);
+    assert(time.tm_year == expected.tm_year && time.tm_mon == expected.tm_mon && time.tm_mday == expected.tm_mday);
+    assert(time.tm_wday == expected.tm_wday && time.tm_yday == expected.tm_yday && time.tm_yday == 59);
+  }
+
+  const RtcDueRcf_ReadStatistics statistics;
+  assert(statistics.reads() == 0 && statistics.failures() == 0 && statistics.maxRetries() == 0);
+  assert(statistics.histogram(0) == 0 && statistics.histogram(100) == 0);
+  delay(100);
+}
+
+static void test_setTimeStateMachine(Stream& log) {
+  log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  constexpr uint8_t X = RtcDueRcf_Alarm::INVALID_VALUE;
+  typedef RtcRegs<2016, 3, 27, 1, 59, 50> OldTime;
+  typedef RtcRegs<2016, 3, 27, 3, 0, 0, true> NewTime;
+  typedef RtcAlarmRegs<13, X, 40, X, X> Alarm;
+
+  // Simulated register block. The RTC runs in 24-hrs mode.
+  Rtc rtc = {};
+  rtc.RTC_TIMR = OldTime::timeReg;
+  rtc.RTC_CALR = OldTime::calReg;
+  rtc.RTC_TIMALR = Alarm::timeAlarmReg24;
+
+  // Request
+  RTC_RequestTimeAndDateUpdate(&rtc);
+  assert((rtc.RTC_CR & (RTC_CR_UPDTIM | RTC_CR_UPDCAL)) == (RTC_CR_UPDTIM | RTC_CR_UPDCAL));
+
+  // Not yet acknowledged. Must return immediately without writing.
+  unsigned retFlags = RTC_CommitTimeAndDate(&rtc, NewTime::timeReg, NewTime::calReg, NewTime::rtc12HrsMode);
+  assert(retFlags & (1 << RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED));
+  assert(rtc.RTC_TIMR == OldTime::timeReg && rtc.RTC_CALR == OldTime::calReg && rtc.RTC_MR == 0);
+  assert(rtc.RTC_CR & RTC_CR_UPDTIM);
+
+  // Acknowledge and commit. The alarm hour follows the new hour mode.
+  rtc.RTC_SR = RTC_SR_ACKUPD;
+  retFlags = RTC_CommitTimeAndDate(&rtc, NewTime::timeReg, NewTime::calReg, NewTime::rtc12HrsMode);
+  assert(not (retFlags & (1 << RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED)));
+  assert(rtc.RTC_TIMR == NewTime::timeReg && rtc.RTC_CALR == NewTime::calReg && rtc.RTC_MR == RTC_MR_HRMOD);
+  assert((rtc.RTC_CR & (RTC_CR_UPDTIM | RTC_CR_UPDCAL)) == 0);
+  assert(rtc.RTC_TIMALR == Alarm::timeAlarmReg12);
+
+  // Cancel
+  RTC_RequestTimeAndDateUpdate(&rtc);
+  RTC_CancelTimeAndDateUpdate(&rtc);
+  assert((rtc.RTC_CR & (RTC_CR_UPDTIM | RTC_CR_UPDCAL)) == 0);
+  assert(rtc.RTC_TIMR == NewTime::timeReg);
+
+  // Commit along with a new alarm in the new hour mode.
+  typedef RtcAlarmRegs<3, 0, 5, X, X> NewAlarm;
+  rtc.RTC_MR = 0;
+  RTC_RequestTimeAndDateUpdate(&rtc);
+  rtc.RTC_SR = 0;
+  retFlags = RTC_CommitTimeDateAndAlarm(&rtc, NewTime::timeReg, NewTime::calReg, NewTime::rtc12HrsMode,
+      NewAlarm::timeAlarmReg12, NewAlarm::calAlarmReg);
+  assert(retFlags & (1 << RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED));
+  assert(rtc.RTC_TIMALR == Alarm::timeAlarmReg12 && rtc.RTC_MR == 0);
+  rtc.RTC_SR = RTC_SR_ACKUPD;
+  retFlags = RTC_CommitTimeDateAndAlarm(&rtc, NewTime::timeReg, NewTime::calReg, NewTime::rtc12HrsMode,
+      NewAlarm::timeAlarmReg12, NewAlarm::calAlarmReg);
+  assert(not (retFlags & (1 << RTC_RET_BITPOS_UPDATE_NOT_ACKNOWLEDGED)));
+  assert(rtc.RTC_TIMR == NewTime::timeReg && rtc.RTC_MR == RTC_MR_HRMOD);
+  assert(rtc.RTC_TIMALR == NewAlarm::timeAlarmReg12 && rtc.RTC_CALALR == NewAlarm::calAlarmReg);
+  assert((rtc.RTC_CR & (RTC_CR_UPDTIM | RTC_CR_UPDCAL)) == 0);
+
+  // Staging of a transaction.
+  {
+    RtcDueRcf_Transaction transaction;
+    assert(not transaction.hasTime() && not transaction.hasAlarm());
+    assert(not RtcDueRcf::clock.commit(transaction));
+    transaction.setTime<NewTime>();
+    assert(transaction.hasTime());
+    // 31st of February
+    assert(not transaction.setAlarm(RtcDueRcf_Alarm(X, X, X, 31, 1)));
+    assert(not transaction.hasAlarm());
+    assert(transaction.setAlarm<NewAlarm>());
+    assert(transaction.hasAlarm());
+  }
+
+  // Worst case: hour mode changes while an hour alarm is enabled.
+  constexpr uint32_t N = 100;
+  startCycleCounter();
+  const uint32_t start = cycleCount();
+  for(uint32_t n = 0; n < N; n++) {
+    rtc.RTC_MR = n & 1 ? 0 : RTC_MR_HRMOD;
+    RTC_CommitTimeAndDate(&rtc, OldTime::timeReg, OldTime::calReg, n & 1);
+  }
+  logCycles(log, "RTC_CommitTimeAndDate (simulated registers)", cycleCount() - start, N);
+  delay(100);
+}
+
 #ifdef TEST_RtcDueRcf // To be set as command line compile option
 
 void test_weekdayOccuranceWithinMonth(Stream &log, const TM &time, const size_t* expectedResults, bool verbosity) {
@@ -638,6 +2157,20 @@ void test_weekdayOcurranceWithinMonth(Stream& log, int verbosity = 0)  {
 
 void runOfflineTests(Stream& log) {
   log.print("--- RtcDueRcf_test::"); log.println(__FUNCTION__);
+  test_bcdCodec(log);
+  test_constexprRegs(log);
+  test_swarValidation(log);
+  test_regsToTimeStamp(log);
+  test_timeZoneParser(log);
+  test_utcToRtcTime(log);
+  test_dstTransitionCache(log);
+  test_eventDrivenDstCheck(log);
+  test_zoneViews(log);
+  test_tzTable(log);
+  test_arithmeticOperators(log);
+  test_timeSeqlock(log);
+  test_boundedSnapshotRead(log);
+  test_setTimeStateMachine(log);
   test_toTimeStamp(log);
 
 #ifdef TEST_RtcTimeInternal  // To be set as command line compile option
@@ -768,6 +2301,18 @@ void runOnlineTests(Stream& log) {
   testRTCisdst(log);
 
   testBasicSetGet(log);
+  testSnapshotRead(log);
+  testTimeStampDecode(log);
+  testSeqlockRead(log);
+  testEventDrivenReads(log);
+  testTimeWithMicros(log);
+  testBoundedRead(log);
+  testUtcTimestamp(log);
+  testTimeOfDayAndDate(log);
+  testCommitNotification(log);
+  testCoalescedSetTime(log);
+  testSetTimeAligned(log);
+  testTransaction(log);
   testDstEntry(log);
   testDstExit(log);
 